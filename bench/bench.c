@@ -0,0 +1,540 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <linux/types.h>
+
+#include <rte_alarm.h>
+
+#include "../src/dpdk_common.h"
+
+/* Defines */
+#define BENCH_MAX_VALUES 16
+#define BENCH_MAX_RESULTS 1024
+#define BENCH_MEMPOOL_ITERATIONS 1000000
+
+/* Structures */
+struct bench_result
+{
+    const char *test;
+    unsigned int burst;
+    unsigned int queues;
+    unsigned int lcores;
+    double mpps;
+    double cycles_per_pkt;
+};
+
+/* Bench options */
+// The amount of seconds to run each forwarding test for.
+static unsigned int duration = 5;
+
+// The burst sizes, queue counts and l-core counts to test.
+static unsigned int bursts[BENCH_MAX_VALUES] = { 32 };
+static unsigned int nb_bursts = 1;
+static unsigned int queues[BENCH_MAX_VALUES] = { 1 };
+static unsigned int nb_queues = 1;
+static unsigned int lcores[BENCH_MAX_VALUES] = { 0 };
+static unsigned int nb_lcores_list = 0;
+
+// The files to write results to (NULL = don't write).
+static const char *csv_path = NULL;
+static const char *json_path = NULL;
+
+// The results of each test.
+static struct bench_result results[BENCH_MAX_RESULTS];
+static unsigned int nb_results = 0;
+
+// EAL arguments used when none are given so the bench runs without physical NICs.
+static char *default_eal_args[] = { "dpdkc_bench", "--no-pci", "--vdev=net_null0", "--vdev=net_null1", NULL };
+
+/**
+ * Parses a comma separated list of unsigned integers.
+ * 
+ * @param arg The list.
+ * @param vals The array to store the values in.
+ * 
+ * @return The amount of values parsed or 0 on error.
+**/
+static unsigned int bench_parse_list(const char *arg, unsigned int *vals)
+{
+    char buf[256];
+    char *fld[BENCH_MAX_VALUES];
+    char *end;
+    int n, i;
+
+    rte_strlcpy(buf, arg, sizeof(buf));
+
+    if ((n = rte_strsplit(buf, sizeof(buf), fld, BENCH_MAX_VALUES, ',')) <= 0)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        vals[i] = strtoul(fld[i], &end, 10);
+
+        if (end == fld[i] || vals[i] == 0)
+        {
+            return 0;
+        }
+    }
+
+    return n;
+}
+
+/**
+ * Parses the bench arguments (after the EAL arguments).
+ * 
+ * @param argc The argument count.
+ * @param argv Pointer to arguments array.
+ * 
+ * @return 0 on success or -1 on error.
+**/
+static int bench_parse_args(int argc, char **argv)
+{
+    static const struct option opts[] =
+    {
+        { "duration", required_argument, NULL, 'd' },
+        { "bursts", required_argument, NULL, 'b' },
+        { "queues", required_argument, NULL, 'q' },
+        { "lcores", required_argument, NULL, 'l' },
+        { "csv", required_argument, NULL, 'c' },
+        { "json", required_argument, NULL, 'j' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int c;
+
+    while ((c = getopt_long(argc, argv, "d:b:q:l:c:j:", opts, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 'd':
+                duration = strtoul(optarg, NULL, 10);
+
+                break;
+
+            case 'b':
+                if ((nb_bursts = bench_parse_list(optarg, bursts)) == 0)
+                {
+                    return -1;
+                }
+
+                break;
+
+            case 'q':
+                if ((nb_queues = bench_parse_list(optarg, queues)) == 0)
+                {
+                    return -1;
+                }
+
+                break;
+
+            case 'l':
+                if ((nb_lcores_list = bench_parse_list(optarg, lcores)) == 0)
+                {
+                    return -1;
+                }
+
+                break;
+
+            case 'c':
+                csv_path = optarg;
+
+                break;
+
+            case 'j':
+                json_path = optarg;
+
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [EAL args] -- [--duration <secs>] [--bursts <n,...>] [--queues <n,...>] [--lcores <n,...>] [--csv <file>] [--json <file>]\n", argv[0]);
+
+                return -1;
+        }
+    }
+
+    return (duration > 0) ? 0 : -1;
+}
+
+/**
+ * Alarm callback that stops the forwarder after the test duration.
+ * 
+ * @param arg Unused.
+ * 
+ * @return Void
+**/
+static void bench_stop(void *arg)
+{
+    quit = 1;
+}
+
+/**
+ * Stops all ports and releases the per-run state so the ports can be reconfigured.
+ * 
+ * @return Void
+**/
+static void bench_reset()
+{
+    struct lcore_port_conf *qconf;
+    unsigned int lcore, i;
+    __u16 pid;
+
+    RTE_ETH_FOREACH_DEV(pid)
+    {
+        if (!dpdkc_port_mask_test(enabled_port_mask, pid))
+        {
+            continue;
+        }
+
+        rte_eth_dev_stop(pid);
+
+        rte_free(ports[pid].tx_buffer);
+        ports[pid].tx_buffer = NULL;
+    }
+
+    RTE_LCORE_FOREACH(lcore)
+    {
+        qconf = &lcore_port_conf[lcore];
+
+        for (i = 0; i < RTE_MAX_ETHPORTS; i++)
+        {
+            rte_free(qconf->tx_buffer[i]);
+            qconf->tx_buffer[i] = NULL;
+        }
+
+        // Empty the l-core's lists but keep their memory (and the pool binding from dpdkc_create_mbuf()) for the next run.
+        qconf->num_rx_ports = 0;
+        qconf->num_tx_ports = 0;
+        qconf->num_rx_queues = 0;
+        qconf->tx_queue_id = 0;
+    }
+
+    memset(lcore_stats, 0, sizeof(lcore_stats));
+
+    nb_ports_available = 0;
+}
+
+/**
+ * Maps every (port, queue) pair to the first nb_run_lcores enabled l-cores in a round-robin fashion.
+ * 
+ * @param nb_run_lcores The amount of l-cores to use.
+ * @param nb_run_queues The amount of RX queues per port.
+ * 
+ * @return 0 on success or -ENOMEM if an l-core's lists couldn't grow.
+**/
+static int bench_map(unsigned int nb_run_lcores, unsigned int nb_run_queues)
+{
+    struct lcore_port_conf *qconf;
+    unsigned int run_lcores[RTE_MAX_LCORE];
+    unsigned int lcore, n = 0, next = 0;
+    unsigned int q;
+    __u16 pid;
+
+    // Collect the first nb_run_lcores enabled l-cores. Each one transmits on the queue matching its index.
+    RTE_LCORE_FOREACH(lcore)
+    {
+        if (n >= nb_run_lcores)
+        {
+            break;
+        }
+
+        lcore_port_conf[lcore].tx_queue_id = n;
+        run_lcores[n++] = lcore;
+    }
+
+    RTE_ETH_FOREACH_DEV(pid)
+    {
+        if (!dpdkc_port_mask_test(enabled_port_mask, pid) || !ports[pid].rx)
+        {
+            continue;
+        }
+
+        for (q = 0; q < nb_run_queues; q++)
+        {
+            qconf = &lcore_port_conf[run_lcores[next]];
+
+            // The l-core's lists grow as needed.
+            if (dpdkc_lcore_add_rx_queue(qconf, pid, q) != 0)
+            {
+                return -ENOMEM;
+            }
+
+            if ((qconf->num_rx_ports == 0 || qconf->rx_port_list[qconf->num_rx_ports - 1] != pid) && dpdkc_lcore_add_port(qconf, pid, 0) != 0)
+            {
+                return -ENOMEM;
+            }
+
+            next = (next + 1) % n;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Runs the built-in forwarder for the configured duration and stores the result.
+ * 
+ * @param burst The burst size.
+ * @param nb_run_queues The amount of RX queues per port.
+ * @param nb_run_lcores The amount of l-cores to use.
+ * 
+ * @return Void
+**/
+static void bench_forward(unsigned int burst, unsigned int nb_run_queues, unsigned int nb_run_lcores)
+{
+    struct dpdkc_ret ret;
+    struct bench_result *res;
+    __u64 start, end, pkts = 0;
+    unsigned int lcore;
+    __u16 pid;
+
+    bench_reset();
+
+    packet_burst_size = burst;
+    rx_queue_pp = nb_run_queues;
+
+    if (bench_map(nb_run_lcores, nb_run_queues) != 0)
+    {
+        fprintf(stdout, "Skipping queues=%u lcores=%u (failed to grow l-core lists).\n", nb_run_queues, nb_run_lcores);
+
+        return;
+    }
+
+    // Each l-core transmits on its own queue.
+    ret = dpdkc_ports_queues_init(0, nb_run_queues, nb_run_lcores);
+    dpdkc_check_ret(&ret);
+
+    quit = 0;
+    rte_eal_alarm_set((__u64)duration * US_PER_S, bench_stop, NULL);
+
+    start = rte_rdtsc();
+    dpdkc_run_forwarder(NULL);
+    end = rte_rdtsc();
+
+    RTE_LCORE_FOREACH(lcore)
+    {
+        pkts += lcore_stats[lcore].rx_pkts;
+    }
+
+    // Don't let a stalled run divide by zero.
+    if (pkts == 0)
+    {
+        pkts = 1;
+    }
+
+    if (nb_results >= BENCH_MAX_RESULTS)
+    {
+        return;
+    }
+
+    res = &results[nb_results++];
+
+    res->test = "forward";
+    res->burst = burst;
+    res->queues = nb_run_queues;
+    res->lcores = nb_run_lcores;
+    res->mpps = (double)pkts / ((double)(end - start) / rte_get_tsc_hz()) / 1000000;
+    res->cycles_per_pkt = (double)(end - start) * nb_run_lcores / pkts;
+
+    fprintf(stdout, "forward burst=%u queues=%u lcores=%u => %.3f Mpps, %.1f cycles/pkt.\n", burst, nb_run_queues, nb_run_lcores, res->mpps, res->cycles_per_pkt);
+
+    RTE_ETH_FOREACH_DEV(pid)
+    {
+        if (!dpdkc_port_mask_test(enabled_port_mask, pid))
+        {
+            continue;
+        }
+
+        rte_eth_stats_reset(pid);
+    }
+}
+
+/**
+ * Measures the cost of getting and putting a burst of mbufs from/to the main pool.
+ * 
+ * @param burst The burst size.
+ * 
+ * @return Void
+**/
+static void bench_mempool(unsigned int burst)
+{
+    void *objs[MAX_PCKT_BURST];
+    struct bench_result *res;
+    __u64 start, end;
+    unsigned int i;
+
+    start = rte_rdtsc_precise();
+
+    for (i = 0; i < BENCH_MEMPOOL_ITERATIONS; i++)
+    {
+        if (rte_mempool_get_bulk(pcktmbuf_pool, objs, burst) != 0)
+        {
+            continue;
+        }
+
+        rte_mempool_put_bulk(pcktmbuf_pool, objs, burst);
+    }
+
+    end = rte_rdtsc_precise();
+
+    if (nb_results >= BENCH_MAX_RESULTS)
+    {
+        return;
+    }
+
+    res = &results[nb_results++];
+
+    res->test = "mempool";
+    res->burst = burst;
+    res->queues = 0;
+    res->lcores = 1;
+    res->mpps = 0;
+    res->cycles_per_pkt = (double)(end - start) / ((__u64)BENCH_MEMPOOL_ITERATIONS * burst);
+
+    fprintf(stdout, "mempool burst=%u => %.1f cycles/mbuf (get + put).\n", burst, res->cycles_per_pkt);
+}
+
+/**
+ * Writes all results as CSV and/or JSON.
+ * 
+ * @return Void
+**/
+static void bench_write_results()
+{
+    FILE *fp;
+    unsigned int i;
+
+    if (csv_path != NULL && (fp = fopen(csv_path, "w")) != NULL)
+    {
+        fprintf(fp, "test,burst,queues,lcores,mpps,cycles_per_pkt\n");
+
+        for (i = 0; i < nb_results; i++)
+        {
+            fprintf(fp, "%s,%u,%u,%u,%.3f,%.2f\n", results[i].test, results[i].burst, results[i].queues, results[i].lcores, results[i].mpps, results[i].cycles_per_pkt);
+        }
+
+        fclose(fp);
+    }
+
+    if (json_path != NULL && (fp = fopen(json_path, "w")) != NULL)
+    {
+        fprintf(fp, "[\n");
+
+        for (i = 0; i < nb_results; i++)
+        {
+            fprintf(fp, "  {\"test\": \"%s\", \"burst\": %u, \"queues\": %u, \"lcores\": %u, \"mpps\": %.3f, \"cycles_per_pkt\": %.2f}%s\n", results[i].test, results[i].burst, results[i].queues, results[i].lcores, results[i].mpps, results[i].cycles_per_pkt, (i + 1 < nb_results) ? "," : "");
+        }
+
+        fprintf(fp, "]\n");
+
+        fclose(fp);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    struct dpdkc_ret ret;
+    unsigned int max_burst = 0, max_queues = 0;
+    unsigned int b, q, l;
+    __u16 pid;
+
+    // Use net_null ports when no EAL arguments are given.
+    if (argc == 1)
+    {
+        argc = RTE_DIM(default_eal_args) - 1;
+        argv = default_eal_args;
+    }
+
+    // Initialize EAL and skip its arguments.
+    ret = dpdkc_eal_init(argc, argv);
+    dpdkc_check_ret(&ret);
+
+    argc -= ret.data;
+    argv += ret.data;
+
+    if (bench_parse_args(argc, argv) != 0)
+    {
+        rte_exit(EXIT_FAILURE, "Invalid bench arguments.\n");
+    }
+
+    // Use every port and pair them up.
+    ret = dpdkc_get_nb_ports();
+    dpdkc_check_ret(&ret);
+
+    memset(enabled_port_mask, 0, sizeof(enabled_port_mask));
+
+    for (pid = 0; pid < nb_ports; pid++)
+    {
+        dpdkc_port_mask_set(enabled_port_mask, pid);
+    }
+
+    dpdkc_reset_dst_ports();
+    dpdkc_populate_dst_ports();
+
+    ret = dpdkc_get_available_lcore_count();
+    dpdkc_check_ret(&ret);
+
+    // Default to testing with every l-core.
+    if (nb_lcores_list == 0)
+    {
+        lcores[0] = nb_lcores;
+        nb_lcores_list = 1;
+    }
+
+    // Size the pools for the largest configuration tested.
+    for (b = 0; b < nb_bursts; b++)
+    {
+        bursts[b] = RTE_MIN(bursts[b], MAX_PCKT_BURST);
+        max_burst = RTE_MAX(max_burst, bursts[b]);
+    }
+
+    for (q = 0; q < nb_queues; q++)
+    {
+        max_queues = RTE_MAX(max_queues, queues[q]);
+    }
+
+    packet_burst_size = max_burst;
+    rx_queue_pp = max_queues;
+    tx_queue_pp = nb_lcores;
+
+    ret = dpdkc_create_mbuf();
+    dpdkc_check_ret(&ret);
+
+    for (b = 0; b < nb_bursts; b++)
+    {
+        bench_mempool(bursts[b]);
+    }
+
+    for (l = 0; l < nb_lcores_list; l++)
+    {
+        if (lcores[l] > nb_lcores)
+        {
+            fprintf(stdout, "Skipping %u l-cores (only %u enabled).\n", lcores[l], nb_lcores);
+
+            continue;
+        }
+
+        for (q = 0; q < nb_queues; q++)
+        {
+            for (b = 0; b < nb_bursts; b++)
+            {
+                bench_forward(bursts[b], queues[q], lcores[l]);
+            }
+        }
+    }
+
+    bench_write_results();
+
+    bench_reset();
+
+    ret = dpdkc_port_stop_and_remove();
+    dpdkc_check_ret(&ret);
+
+    ret = dpdkc_eal_cleanup();
+    dpdkc_check_ret(&ret);
+
+    return 0;
+}
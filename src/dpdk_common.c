@@ -9,11 +9,21 @@
 #include <errno.h>
 #include <getopt.h>
 #include <signal.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
 
 #define USE_HASH_TABLES
 
 #include "dpdk_common.h"
 
+#include <rte_vect.h>
+
 /* Global variables that may be used in other programs. */
 // Variable to use for signals.
 volatile __u8 quit;
@@ -22,8 +32,8 @@ volatile __u8 quit;
 __u16 nb_rxd = RTE_RX_DESC_DEFAULT;
 __u16 nb_txd = RTE_TX_DESC_DEFAULT;
 
-// The enabled port mask.
-__u32 enabled_port_mask = 0;
+// The enabled port mask (one bit per port ID up to RTE_MAX_ETHPORTS, see dpdkc_port_mask_test()).
+__u64 enabled_port_mask[PORT_MASK_WORDS];
 
 // Port pair params array.
 struct port_pair_params port_pair_params_array[RTE_MAX_ETHPORTS / 2];
@@ -60,1134 +70,7555 @@ struct rte_eth_conf port_conf =
 {
     .rxmode =
     {
-        .mq_mode = RTE_ETH_MQ_TX_NONE
+        .mq_mode = RTE_ETH_MQ_RX_NONE
     }
 };
 
-// A pointer to the mbuf_pool for packets.
+// The RSS hash functions to request when a port has more than one RX queue.
+__u64 rss_hf = RSS_HF_DEFAULT;
+
+// The RSS hash key and its length (a length of 0 uses the PMD's default key).
+__u8 rss_key[RSS_KEY_MAX_LEN];
+__u8 rss_key_len = 0;
+
+// A pointer to the mbuf_pool for packets (the main l-core's socket pool).
 struct rte_mempool *pcktmbuf_pool = NULL;
 
-// The current port ID.
+// The mbuf pools for packets indexed by NUMA socket (NULL if the socket has no ports or l-cores).
+struct rte_mempool *pcktmbuf_pools[RTE_MAX_NUMA_NODES];
+
+// The data room size (including headroom) and application private area size of each mbuf.
+__u16 mbuf_data_room = RTE_MBUF_DEFAULT_BUF_SIZE;
+__u16 mbuf_priv_size = 0;
+
+// Extra mbufs to add to each pool for packets the application holds on to (e.g. queued or generated packets).
+unsigned int mbuf_extra = 0;
+
+// Left for applications that used it as a loop variable. The library doesn't write it (see lcore_ctx[] for per l-core state).
 __u16 port_id = 0;
 
 // Number of ports and ports available.
 __u16 nb_ports = 0;
 __u16 nb_ports_available = 0;
 
-// L-core ID.
+// Left for applications that used it as a loop variable. The library doesn't write it (see lcore_ctx[] for per l-core state).
 unsigned int lcore_id = 0;
 
 // Number of l-cores.
 unsigned int nb_lcores = 0;
 
-/**
- * Returns whether or not the currently set port_id is enabled with the configured port mask.
- * WARNING - Static function (cannot use outside of this file).
- * 
- * @return 1 on enabled or 0 on disabled.
-**/
-static int dpdkc_port_enabled()
-{
-    return (enabled_port_mask & (1 << port_id)) > 0;
-}
+// Per l-core statistics (only written by their own l-core).
+struct dpdkc_lcore_stats lcore_stats[RTE_MAX_LCORE];
 
-/**
- * Initializes a DPDK Common result type and returns it with default values.
- * 
- * @return The DPDK Common return structure (struct dpdkc_ret) with its default values.
-**/
-struct dpdkc_ret dpdkc_ret_init()
-{
-    struct dpdkc_ret ret =
-    {
-        .err_num = 0,
-        .gen_msg = NULL,
-        .port_id = -1,
-        .rx_id = -1,
-        .tx_id = -1,
-        .data = -1,
-        .dataptr = NULL
-    };
+// The period in seconds between statistics reports in the built-in forwarder (0 = disabled).
+unsigned int stats_period = 0;
 
-    return ret;
-}
+// If 1, the built-in forwarder grows/shrinks each l-core's RX burst size and TX buffer threshold based on how full its bursts are.
+unsigned int adaptive_burst = 0;
 
-/**
- * Parses the port mask argument and stores it in the enabled_port_mask global variable.
- * 
- * @param arg A (const) pointer to the optarg variable from getopt.h.
- * 
- * @return The DPDK Common return structure (struct dpdkc_ret). The port mask is stored in ret->data.
-**/
-struct dpdkc_ret dpdkc_parse_arg_port_mask(const char *arg)
-{
-    // Create DPDK Common's return structure.
-    struct dpdkc_ret ret = dpdkc_ret_init();
+// The amount of consecutive empty poll loops before the built-in forwarder backs off (0 = always spin).
+unsigned int idle_poll_threshold = 0;
 
-    char *end = NULL;
-    unsigned long pm;
+// The amount of microseconds to sleep per backoff once an l-core has been idle for twice the threshold.
+unsigned int idle_sleep_us = IDLE_SLEEP_US_DEFAULT;
 
-    // Parse hexadecimal.
-    pm = strtoul(arg, &end, 16);
+// If 1, idle l-cores with a single RX queue wait on the queue's next descriptor with rte_power_monitor() (UMWAIT) instead of sleeping.
+unsigned int idle_power_monitor = 0;
 
-    // Store port mask in global port mask variable.
-    enabled_port_mask = pm;
+// Installed flow rules (hardware or software fallback), indexed by rule ID.
+struct dpdkc_flow_handle flow_rules[MAX_FLOW_RULES];
 
-    // Also store value in data.
-    ret.data = pm;
+// The size of each pipeline ring (must be a power of 2).
+unsigned int pipeline_ring_size = PIPELINE_RING_SIZE_DEFAULT;
 
-    return ret;
-}
+// How RX l-cores spread packets over the pipeline's workers (PIPELINE_DIST_BURST or PIPELINE_DIST_FLOW).
+unsigned int pipeline_dist_mode = PIPELINE_DIST_BURST;
 
-/**
- * Parses the port pair config.
- * 
- * @param arg A (const) pointer to the optarg variable from getopt.h.
- * 
- * @return The DPDK Common return structure (struct dpdkc_ret).
-**/
-struct dpdkc_ret dpdkc_parse_arg_port_pair_config(const char *arg)
-{
-    // Create DPDK Common's return structure.
-    struct dpdkc_ret ret = dpdkc_ret_init();
+// The size in bytes of each l-core's arena (see dpdkc_arenas_init()).
+unsigned int arena_size = ARENA_SIZE_DEFAULT;
 
-    // For readability, we'll define these in an enum.s
-    enum fieldnames
-    {
-        FLD_PORT1 = 0,
-        FLD_PORT2,
-        _NUM_FLD
-    };
+// Per l-core arenas and object pools (only used by their own l-core).
+struct dpdkc_arena lcore_arena[RTE_MAX_LCORE];
 
-    // This array holds the values (integers) of the port IDs to pair.
-    unsigned long int_fld[_NUM_FLD];
+// Per l-core contexts passed to functions launched by dpdkc_launch_and_run() (read-only while l-cores run, apart from the data pointer).
+struct dpdkc_lcore_ctx lcore_ctx[RTE_MAX_LCORE];
 
-    // This array holds the values (strings) of the port IDs to pair.
-    char *str_fld[_NUM_FLD];
+// The published forwarding config read by the fast path (see dpdkc_fwd_conf_get() and dpdkc_reconf_commit()).
+struct dpdkc_fwd_conf *fwd_conf = NULL;
 
-    // Useful pointers for parsing port pair.  
-    const char *p, *p0 = arg;
+// If 1, dpdkc_ports_queues_init() initializes ports on idle worker l-cores in parallel.
+unsigned int parallel_port_init = 0;
 
-    // Buffer for data in-between each () representing a port pair.
-    char s[256];
-    
-    // The size of the data in-between each () representing a port pair.
-    unsigned int size;
-    
-    // Pointer to use with str to unsigned long functions.
-    char *end;
+// The detail of the last datapath error in each thread (see dpdkc_set_err()).
+RTE_DEFINE_PER_LCORE(const char *, dpdkc_errmsg);
 
-    // Variable for iterations.
-    int i;
+#ifdef USE_LATENCY_HIST
+// Per l-core hot path latency histograms (only written by their own l-core).
+struct dpdkc_latency_hist lcore_hist[RTE_MAX_LCORE];
+#endif
 
-    // Set the number of port pair parameters to 0.s
-    nb_port_pair_params = 0;
+/* Static variables used only within this file. */
+// Startup phases timed for dpdkc_startup_timing_print().
+enum dpdkc_init_phase
+{
+    INIT_PHASE_EAL,
+    INIT_PHASE_MBUF,
+    INIT_PHASE_PORTS,
+    INIT_PHASE_LINK,
+    INIT_PHASE_MAX
+};
 
-    // Loop through each value in format (x,y).
-    while ((p = strchr(p0, '(')) != NULL)
-    {
-        // Increase our address one.
-        p++;
+enum dpdkc_port_phase
+{
+    PORT_PHASE_CONFIGURE,
+    PORT_PHASE_QUEUES,
+    PORT_PHASE_START,
+    PORT_PHASE_MAX
+};
 
-        // Now find the ending address where the ending ')' is.
-        p0 = strchr(p, ')');
+static __u64 init_phase_ns[INIT_PHASE_MAX];
+static __u64 port_init_ns[RTE_MAX_ETHPORTS][PORT_PHASE_MAX];
 
-        // Check if we're NULL (otherwise may segfault).
-        if (p == NULL)
-        {
-            ret.err_num = -1;
-            ret.gen_msg = "Port pair variable p is NULL.";
+// The ports left to initialize by dpdkc_port_init_lcore() along with each port's result.
+static __u16 port_init_list[RTE_MAX_ETHPORTS];
+static struct dpdkc_ret port_init_rets[RTE_MAX_ETHPORTS];
+static unsigned int nb_port_init_list = 0;
+static unsigned int port_init_next = 0;
+static int port_init_promisc = 0;
+static int port_init_rx_queues = 0;
+static int port_init_tx_queues = 0;
 
-            return ret;
-        }
+// Signaled by the LSC event callback to wake link waiters.
+static pthread_mutex_t link_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t link_cond = PTHREAD_COND_INITIALIZER;
+static unsigned int lsc_cb_registered = 0;
+static unsigned int rmv_cb_registered = 0;
 
-        // Get the size of the pair values.
-        size = p0 - p;
+// The amount of removed ports still being torn down (see dpdkc_port_rmv_thread()).
+static unsigned int rmv_pending = 0;
 
-        // It should not be even close to 256 bytes.
-        if (size >= sizeof(s))
-        {
-            ret.err_num = -1;
-            ret.gen_msg = "Port pair data size exceeds 256 bytes (should never happen).";
+// L-cores polling or transmitting on ports report quiescent states so removed ports and old forwarding configs are only released once no l-core uses them.
+static struct rte_rcu_qsbr *port_qsbr = NULL;
 
-            return ret;
-        }
+// Whether each l-core is registered with port_qsbr (see dpdkc_lcore_online()).
+static __u8 lcore_qsbr_online[RTE_MAX_LCORE];
 
-        // Copy the port pair data to 's' char array.
-        memcpy(s, p, size);
-        
-        // Last byte should be 0x00.
-        s[size] = '\0';
+// Serializes publishing forwarding configs.
+static pthread_mutex_t reconf_lock = PTHREAD_MUTEX_INITIALIZER;
 
-        // Split string by ',' which divides both integers for port pair.
-        if (rte_strsplit(s, sizeof(s), str_fld, _NUM_FLD, ',') != _NUM_FLD)
-        {
-            ret.err_num = -1;
-            ret.gen_msg = "Failed to split port pair data.";
-            
-            return ret;
-        }
+// Scratch space for dpdkc_reconf_commit() to find RX queues mapped twice (guarded by reconf_lock).
+static __u8 reconf_polled[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
 
-        // Loop through _NUM_FLD (should be 2).
-        for (i = 0; i < _NUM_FLD; i++)
-        {
-            // Resest error number.
-            errno = 0;
+// Per thread buffer for error details formatted by dpdkc_set_errf().
+static RTE_DEFINE_PER_LCORE(char[ERR_DETAIL_MAX], dpdkc_errbuf);
 
-            // Copy unsigned long to int_fld at i index.
-            int_fld[i] = strtoul(str_fld[i], &end, 0);
-            
-            // If error isn't empty, we're locaated at the ')' character or we exceed max ethernet ports, fail.
-            if (errno != 0 || end == str_fld[i] || int_fld[i] >= RTE_MAX_ETHPORTS)
-            {
-                ret.err_num = errno;
-                ret.gen_msg = "Error number present or reached out of port pair data.";
-                
-                return ret;
-            }
-        }
+// The batch callback the built-in forwarder calls for each RX burst.
+static dpdkc_batch_cb fwd_cb = NULL;
 
-        // Make sure we don't exceed max number of port pairs.
-        if (nb_port_pair_params >= RTE_MAX_ETHPORTS / 2)
-        {
-            ret.err_num = -1;
-            ret.gen_msg = "Exceeded maximum number of port pairs.";
-            
-            return ret;
-        }
+// The software fallback flow rule IDs of each port, sorted by priority.
+static __u16 sw_flow_rule_ids[RTE_MAX_ETHPORTS][MAX_FLOW_RULES];
 
-        // Assign port pair values (x, y) to port pair params array and increment number of port pairs.
-        port_pair_params_array[nb_port_pair_params].port[0] = (__u16)int_fld[FLD_PORT1];
-        port_pair_params_array[nb_port_pair_params].port[1] = (__u16)int_fld[FLD_PORT2];
+// The error callback (and its user data) unsent packets from l-core TX buffers are handed to. NULL counts them in tx_dropped and frees them.
+static buffer_tx_error_fn tx_err_cb = NULL;
+static void *tx_err_userdata = NULL;
 
-        nb_port_pair_params++;
-    }
+// The generator's configuration, template pool and template layout (see dpdkc_gen_init()).
+static struct dpdkc_gen_conf gen_conf;
+static struct rte_mempool *gen_pool = NULL;
+static __u8 gen_pkt[RTE_MBUF_DEFAULT_DATAROOM];
+static __u16 gen_l3_off = 0;
+static __u16 gen_l4_off = 0;
+static __u8 gen_l4_proto = 0;
+static __u64 gen_tx_ol_flags = 0;
 
-    // Assign port pair array to port pair params.
-    port_pair_params = port_pair_params_array;
+// Per l-core token bucket used to pace the generator and replay (in 1/65536 TSC cycles).
+struct dpdkc_token_bucket
+{
+    __u64 cost;
+    __u64 depth;
+    __u64 credit;
+    __u64 prev_tsc;
+};
 
-    // Success!
-    ret.err_num = 0;
+// Packet capture state (see dpdkc_capture_start()).
+struct dpdkc_capture_meta
+{
+    __u64 tsc;
+    __u32 orig_len;
+};
 
-    return ret;
+static volatile unsigned int capture_dirs = 0;
+static volatile int capture_stop_writer = 0;
+static unsigned int capture_sample = 1;
+static __u32 capture_snaplen = 0;
+static dpdkc_capture_filter capture_filter = NULL;
+static struct rte_ring *capture_rings[RTE_MAX_LCORE];
+static struct rte_mempool *capture_pool = NULL;
+static FILE *capture_file = NULL;
+static char *capture_buf = NULL;
+static pthread_t capture_thread;
+static __u64 capture_start_tsc = 0;
+static struct timeval capture_start_tv;
+static __u64 capture_written = 0;
+
+// Packets preloaded by dpdkc_replay_load() and the replay's settings.
+static struct rte_mbuf **replay_pkts = NULL;
+static __u16 *replay_lens = NULL;
+static __u32 nb_replay_pkts = 0;
+static __u16 replay_port = 0;
+static __u64 replay_pps = 0;
+static unsigned int replay_loops = 1;
+
+// The pipeline's worker and TX l-cores in mapping order.
+static unsigned int pipeline_workers[RTE_MAX_LCORE];
+static unsigned int nb_pipeline_workers = 0;
+static unsigned int pipeline_tx_lcores[RTE_MAX_LCORE];
+static unsigned int nb_pipeline_tx_lcores = 0;
+
+// Pattern, action and spec storage used when building a rte_flow rule.
+struct dpdkc_flow_spec
+{
+    struct rte_flow_attr attr;
+    struct rte_flow_item pattern[5];
+    struct rte_flow_action actions[2];
+    struct rte_flow_item_eth eth_spec;
+    struct rte_flow_item_eth eth_mask;
+    struct rte_flow_item_ipv4 ip_spec;
+    struct rte_flow_item_ipv4 ip_mask;
+    struct rte_flow_item_tcp tcp_spec;
+    struct rte_flow_item_tcp tcp_mask;
+    struct rte_flow_item_udp udp_spec;
+    struct rte_flow_item_udp udp_mask;
+    struct rte_flow_action_queue queue;
+    struct rte_flow_action_mark mark;
+    struct rte_flow_action_rss rss;
+    __u16 rss_queues[FLOW_RSS_MAX_QUEUES];
+};
+
+/**
+ * Returns whether or not a port is enabled with the configured port mask.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param pid The port ID.
+ * 
+ * @return 1 on enabled or 0 on disabled.
+**/
+static int dpdkc_port_enabled(__u16 pid)
+{
+    return dpdkc_port_mask_test(enabled_port_mask, pid);
 }
 
 /**
- * Parses the queue number argument and stores it in the global variable(s).
+ * Returns the NUMA socket of a port, falling back to the main l-core's socket when the device doesn't report one.
+ * WARNING - Static function (cannot use outside of this file).
  * 
- * @param arg A (const) pointer to the optarg variable from getopt.h.
- * @param rx Whether this is a RX queue count.
- * @param tx Whether this is a TX queue count.
+ * @param pid The port ID.
  * 
- * @return The DPDK Common return structure (struct dpdkc_ret). The amount of queues is stored in ret->data.
+ * @return The NUMA socket ID.
 **/
-struct dpdkc_ret dpdkc_parse_arg_queues(const char *arg, int rx, int tx)
+static int dpdkc_port_socket(__u16 pid)
 {
-    // Create DPDK Common's return structure.
-    struct dpdkc_ret ret = dpdkc_ret_init();
+    int socket_id = rte_eth_dev_socket_id(pid);
 
-    // Initialize a couple necessary variables.
-    char *end = NULL;
-    unsigned long n;
+    if (socket_id < 0 || socket_id >= RTE_MAX_NUMA_NODES)
+    {
+        socket_id = rte_socket_id();
+    }
 
-    // We must parse the hexadecimal.
-    n = strtol(arg, &end, 10);
+    return socket_id;
+}
 
-    // Check queue count.
-    if (n < 1)
-    {
-        ret.err_num = -1;
-        ret.gen_msg = "Amount of queues is below 0.";
+/**
+ * Checks whether an l-core caches mbufs from a socket's pool, either because it's local to the socket or because it polls or transmits on one of the socket's ports.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param lcore The l-core ID.
+ * @param socket_id The NUMA socket ID.
+ * 
+ * @return 1 if the l-core uses the socket's pool or 0 otherwise.
+**/
+static int dpdkc_lcore_uses_socket(unsigned int lcore, int socket_id)
+{
+    struct lcore_port_conf *qconf = &lcore_port_conf[lcore];
+    unsigned int i;
+    __u16 pid;
 
-        return ret;
+    // The l-core allocates from its local pool.
+    if ((int)rte_lcore_to_socket_id(lcore) == socket_id)
+    {
+        return 1;
     }
 
-    // Make sure we're not above max queue per port.
-    if ((rx && n > MAX_RX_QUEUES_PER_PORT) || (tx && n > MAX_TX_QUEUES_PER_PORT))
+    // Polled RX queues allocate from the port's pool and the packets are freed wherever they're transmitted.
+    for (i = 0; i < qconf->num_rx_queues; i++)
     {
-        ret.err_num = -1;
-        ret.gen_msg = "Too many queues specified.";
+        pid = qconf->rx_queue_list[i].port_id;
 
-        return ret;
+        if (dpdkc_port_socket(pid) == socket_id || (ports[pid].tx_port < RTE_MAX_ETHPORTS && dpdkc_port_socket(ports[pid].tx_port) == socket_id))
+        {
+            return 1;
+        }
     }
 
-    // Store in global variable.
-    if (rx)
+    for (i = 0; i < qconf->num_rx_ports; i++)
     {
-        rx_queue_pp = n;
+        if (dpdkc_port_socket(qconf->rx_port_list[i]) == socket_id)
+        {
+            return 1;
+        }
     }
-    else if (tx)
+
+    for (i = 0; i < qconf->num_tx_ports; i++)
     {
-        tx_queue_pp = n;
+        if (dpdkc_port_socket(qconf->tx_port_list[i]) == socket_id)
+        {
+            return 1;
+        }
     }
 
-    ret.data = n;
+    // Pipeline workers and TX l-cores handle packets from every port.
+    if (qconf->role == LCORE_ROLE_WORKER || qconf->role == LCORE_ROLE_TX)
+    {
+        RTE_ETH_FOREACH_DEV(pid)
+        {
+            if (dpdkc_port_enabled(pid) && dpdkc_port_socket(pid) == socket_id)
+            {
+                return 1;
+            }
+        }
+    }
 
-    return ret;
+    return 0;
 }
 
 /**
- * Checks the port pair config after initialization.
+ * Retrieves the monotonic clock in nanoseconds (usable before the TSC is calibrated by the EAL).
+ * WARNING - Static function (cannot use outside of this file).
  * 
- * @return The DPDK Common return structure (struct dpdkc_ret).
+ * @return The current time in nanoseconds.
 **/
-struct dpdkc_ret dpdkc_check_port_pair_config(void)
+static __u64 dpdkc_now_ns()
 {
-    // Create DPDK Common's return structure.
-    struct dpdkc_ret ret = dpdkc_ret_init();
+    struct timespec ts;
 
-    // Port pair config mask and port pair mask.
-    __u32 ppcm;
-    __u32 ppm;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
 
-    // Other variables for iteration.
-    __u16 index; 
-    __u16 i; 
-    __u16 port_id;
+    return (__u64)ts.tv_sec * NS_PER_S + ts.tv_nsec;
+}
 
-    // Loop through each port pair.
-    for (index = 0; index < nb_port_pair_params; index++)
+/**
+ * Makes sure a dynamically sized list can hold a number of entries (at least doubling its capacity when it grows).
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param list A pointer to the list's pointer (updated if the list moves).
+ * @param cap A pointer to the list's capacity in entries.
+ * @param need The amount of entries needed.
+ * @param size The size of an entry.
+ * 
+ * @return 0 on success or -ENOMEM (the list is left as is).
+**/
+static int dpdkc_list_reserve(void **list, unsigned int *cap, unsigned int need, size_t size)
+{
+    unsigned int new_cap;
+    void *tmp;
+
+    if (need <= *cap)
     {
-        // Reset port 
-        ppm = 0;
+        return 0;
+    }
 
-        // Loop through max number of ports (likely 2).
-        for (i = 0; i < NUM_PORTS; i++)
-        {
-            // Retrieve the port ID (<i = 0>, <i = 1).
-            port_id = port_pair_params[index].port[i];
+    new_cap = RTE_MAX(RTE_MAX(*cap * 2, need), (unsigned int)LCORE_LIST_INIT_SIZE);
 
-            // Check if this port is enabled via the port mask.
-            if (enabled_port_mask & (1 << port_id) == 0)
-            {
-                ret.err_num = -1;
-                ret.port_id = port_id;
-                ret.gen_msg = "Port is not enabled in port mask.";
+    if ((tmp = rte_realloc(*list, (size_t)new_cap * size, RTE_CACHE_LINE_SIZE)) == NULL)
+    {
+        return dpdkc_set_err(-ENOMEM, "Failed to grow l-core list.");
+    }
 
-                return ret;
-            }
+    *list = tmp;
+    *cap = new_cap;
 
-            // Check if the port is valid.
-            if (!rte_eth_dev_is_valid_port(port_id))
-            {
-                ret.err_num = -1;
-                ret.port_id = port_id;
-                ret.gen_msg = "Port is not valid.";
+    return 0;
+}
 
-                return ret;
-            }
+/**
+ * Appends an RX queue to an l-core's queue list (growing the list as needed).
+ * 
+ * @param qconf A pointer to the l-core's config.
+ * @param pid The port ID.
+ * @param queue The RX queue ID.
+ * 
+ * @return 0 on success or -ENOMEM.
+**/
+int dpdkc_lcore_add_rx_queue(struct lcore_port_conf *qconf, __u16 pid, __u16 queue)
+{
+    if (dpdkc_list_reserve((void **)&qconf->rx_queue_list, &qconf->max_rx_queues, qconf->num_rx_queues + 1, sizeof(*qconf->rx_queue_list)) != 0)
+    {
+        return -ENOMEM;
+    }
 
-            // Retrieve port pair mask.
-            ppm |= 1 << port_id;
-        }
+    qconf->rx_queue_list[qconf->num_rx_queues].port_id = pid;
+    qconf->rx_queue_list[qconf->num_rx_queues].queue_id = queue;
+    qconf->num_rx_queues++;
 
-        // Check if this port is being used in another pair since we OR the current PPM to the PPCM variable.
-        if (ppcm & ppm)
-        {
-            ret.err_num = -1;
-            ret.port_id = port_id;
-            ret.gen_msg = "Port is being used by another port pair.";
+    return 0;
+}
 
-            return ret;
-        }
+/**
+ * Appends a port to an l-core's RX or TX port list (growing the list as needed).
+ * 
+ * @param qconf A pointer to the l-core's config.
+ * @param pid The port ID.
+ * @param tx If 1, append to the TX port list instead.
+ * 
+ * @return 0 on success or -ENOMEM.
+**/
+int dpdkc_lcore_add_port(struct lcore_port_conf *qconf, __u16 pid, int tx)
+{
+    unsigned **list = tx ? &qconf->tx_port_list : &qconf->rx_port_list;
+    unsigned *nb = tx ? &qconf->num_tx_ports : &qconf->num_rx_ports;
 
-        // OR PPM to PPCM so we can perform check above to ensure this port ID isn't in use with another port pair.
-        ppcm |= ppm;
+    if (dpdkc_list_reserve((void **)list, tx ? &qconf->max_tx_ports : &qconf->max_rx_ports, *nb + 1, sizeof(**list)) != 0)
+    {
+        return -ENOMEM;
     }
 
-    // Set global enabled port mask variable for use elsewhere and return 0 for success.
-    enabled_port_mask &= ppcm;
+    (*list)[(*nb)++] = pid;
 
-    // Return for success!
-    return ret;
+    return 0;
 }
 
 /**
- * Checks and prints the status of all running ports.
+ * Appends an RX queue to an l-core's queue list in a forwarding config.
+ * WARNING - Static function (cannot use outside of this file).
  * 
- * @return Void
+ * @param map A pointer to the l-core's map in the forwarding config.
+ * @param pid The port ID.
+ * @param queue The RX queue ID.
+ * 
+ * @return 0 on success or -ENOMEM.
 **/
-void dpdkc_check_link_status()
+static int dpdkc_lcore_map_add(struct dpdkc_lcore_map *map, __u16 pid, __u16 queue)
 {
-    // Initialize variables.
-    __u16 port_id;
-    __u8 count, all_ports_up, print_flag = 0;
-    struct rte_eth_link link;
-    int ret;
-    char link_status_text[RTE_ETH_LINK_MAX_STR_LEN];
-
-    // Verbose output.
-    fprintf(stdout, "Checking link status...\n");
-    fflush(stdout);
-    
-    // Create loop for checking links and can only occur up to MAX_CHECK_TIME.
-    for (count = 0; count <= MAX_CHECK_TIME; count++)
+    if (dpdkc_list_reserve((void **)&map->rx_queue_list, &map->max_rx_queues, map->num_rx_queues + 1, sizeof(*map->rx_queue_list)) != 0)
     {
-        // If the program is supposed to exit, return.
-        if (quit)
-        {
-            return;
-        }
+        return -ENOMEM;
+    }
 
-        // Assume all ports are up until they aren't.
-        all_ports_up = 1;
+    map->rx_queue_list[map->num_rx_queues].port_id = pid;
+    map->rx_queue_list[map->num_rx_queues].queue_id = queue;
+    map->num_rx_queues++;
 
-        // Loop through all ports.
-        RTE_ETH_FOREACH_DEV(port_id)
-        {
-            // Due to processing time, we want to check if the program has exited again.
-            if (quit)
-            {
-                return;
-            }
+    return 0;
+}
 
-            // Make sure this port is enabled through the port mask.
-            if ((enabled_port_mask & (1 << port_id)) == 0)
-            {
-                continue;
-            }
+/**
+ * Copies an RX queue list into an l-core's map in a forwarding config (which must not own a list yet).
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param map A pointer to the l-core's map in the forwarding config.
+ * @param list A pointer to the RX queue list.
+ * @param nb The amount of RX queues in the list.
+ * 
+ * @return 0 on success or -ENOMEM.
+**/
+static int dpdkc_lcore_map_copy(struct dpdkc_lcore_map *map, const struct lcore_rx_queue *list, unsigned int nb)
+{
+    map->num_rx_queues = 0;
+    map->max_rx_queues = 0;
+    map->rx_queue_list = NULL;
 
-            // Clear the link by setting it to all 0x00 bytes.
-            memset(&link, 0, sizeof(link));
+    if (nb == 0)
+    {
+        return 0;
+    }
 
-            // Retrieve the link with no wait support.
-            ret = rte_eth_link_get_nowait(port_id, &link);
+    if (dpdkc_list_reserve((void **)&map->rx_queue_list, &map->max_rx_queues, nb, sizeof(*list)) != 0)
+    {
+        return -ENOMEM;
+    }
 
-            if (ret < 0)
-            {
-                // Port is down, set all ports up variable to 0 and print message if we were successful before.
-                all_ports_up = 0;
+    memcpy(map->rx_queue_list, list, sizeof(*list) * nb);
+    map->num_rx_queues = nb;
 
-                if (print_flag == 1)
-                {
-                    fprintf(stderr, "Port %u link failed: %s.\n", port_id, rte_strerror(-ret));
+    return 0;
+}
 
-                    continue;
-                }
-            }
+/**
+ * Frees a forwarding config and the RX queue lists it owns.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param conf A pointer to the forwarding config (may be NULL).
+ * 
+ * @return Void
+**/
+static void dpdkc_fwd_conf_free(struct dpdkc_fwd_conf *conf)
+{
+    unsigned int lcore;
 
-            // Print the status of the link if we've scanned successfully all the way through.
-            if (print_flag == 1)
-            {
-                rte_eth_link_to_str(link_status_text, sizeof(link_status_text), &link);
-                fprintf(stdout, "Port %d => %s.\n", port_id, link_status_text);
+    if (conf == NULL)
+    {
+        return;
+    }
 
-                continue;
-            }
+    for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++)
+    {
+        rte_free(conf->lcores[lcore].rx_queue_list);
+    }
 
-            // If the link's status is down itself, set all ports up as 0 and break the loop.
-            if (link.link_status == RTE_ETH_LINK_DOWN)
-            {
-                all_ports_up = 0;
+    rte_free(conf);
+}
 
-                break;
-            }
-        }
+/**
+ * Checks whether an l-core was set up to poll ports by dpdkc_ports_queues_init() (it has TX buffers).
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param lcore The l-core ID.
+ * 
+ * @return 1 if the l-core polls or 0 otherwise.
+**/
+static int dpdkc_lcore_polls(unsigned int lcore)
+{
+    unsigned int pid;
 
-        // If print flag is one (for debug, no actions), break.
-        if (print_flag == 1)
+    for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++)
+    {
+        if (lcore_port_conf[lcore].tx_buffer[pid] != NULL)
         {
-            break;
+            return 1;
         }
+    }
 
-        // If all ports up is 0 (at least on port down), flush stdout and wait CHECK_INTERVAL milliseconds.
-        if (all_ports_up == 0)
-        {
-            fprintf(stdout, ".");
-            fflush(stdout);
+    return 0;
+}
 
-            rte_delay_ms(CHECK_INTERVAL);
-        }
+/**
+ * Copies the installed software flow rules (in priority order) into a forwarding config.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param conf A pointer to the forwarding config.
+ * 
+ * @return Void
+**/
+static void dpdkc_fwd_conf_build_rules(struct dpdkc_fwd_conf *conf)
+{
+    unsigned int pid, j, n = 0;
 
-        // If we were completely successful if we exceed the max check count, set print_flag to 1 for debug only.
-        if (all_ports_up == 1 || count == (MAX_CHECK_TIME - 1))
+    for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++)
+    {
+        conf->sw_rule_start[pid] = n;
+        conf->nb_sw_rules[pid] = ports[pid].nb_sw_flow_rules;
+
+        for (j = 0; j < ports[pid].nb_sw_flow_rules; j++)
         {
-            print_flag = 1;
+            conf->sw_rules[n++] = flow_rules[sw_flow_rule_ids[pid][j]].rule;
         }
     }
 }
 
 /**
- * Initializes the DPDK application's EAL.
+ * Builds a forwarding config from the l-core and port globals (lcore_port_conf[] and ports[]) and the installed software flow rules.
+ * WARNING - Static function (cannot use outside of this file).
  * 
- * @param argc The argument count.
- * @param argv Pointer to arguments array.
+ * @param conf A pointer to the forwarding config (free it with dpdkc_fwd_conf_free() even on failure).
  * 
- * @return The DPDK Common return structure (struct dpdkc_ret).
+ * @return 0 on success or -ENOMEM.
 **/
-struct dpdkc_ret dpdkc_eal_init(int argc, char **argv)
+static int dpdkc_fwd_conf_build(struct dpdkc_fwd_conf *conf)
 {
-    // Create DPDK Common's return structure.
-    struct dpdkc_ret ret = dpdkc_ret_init();
+    unsigned int lcore, pid;
 
-    int tmp = rte_eal_init(argc, argv);
+    memset(conf, 0, sizeof(*conf));
 
-    if (tmp < 0)
+    for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++)
     {
-        ret.err_num = -1;
-        ret.gen_msg = "Failed to initialize EAL.";
+        if (dpdkc_lcore_map_copy(&conf->lcores[lcore], lcore_port_conf[lcore].rx_queue_list, lcore_port_conf[lcore].num_rx_queues) != 0)
+        {
+            return -ENOMEM;
+        }
+    }
 
-        return ret;
+    for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++)
+    {
+        conf->tx_port[pid] = ports[pid].tx_port;
     }
 
-    ret.data = tmp;
+    dpdkc_fwd_conf_build_rules(conf);
 
-    return ret;
+    return 0;
 }
 
 /**
- * Retrieves the amount of ports available.
+ * Publishes a forwarding config in place of the current one.
+ * WARNING - Static function (cannot use outside of this file).
+ * NOTE - The caller must hold reconf_lock and pass the previous config to dpdkc_fwd_conf_retire() once it released the lock.
  * 
- * @return The DPDK Common return structure (struct dpdkc_ret). Number of available ports are stored inside of ret->data.
+ * @param conf A pointer to the forwarding config (owned by the library afterwards).
+ * 
+ * @return A pointer to the previous forwarding config or NULL.
 **/
-struct dpdkc_ret dpdkc_get_nb_ports()
+static struct dpdkc_fwd_conf *dpdkc_fwd_conf_publish(struct dpdkc_fwd_conf *conf)
 {
-    // Create DPDK Common's return structure.
-    struct dpdkc_ret ret = dpdkc_ret_init();
+    return __atomic_exchange_n(&fwd_conf, conf, __ATOMIC_ACQ_REL);
+}
 
-    unsigned short num = rte_eth_dev_count_avail();
+/**
+ * Frees a forwarding config replaced by dpdkc_fwd_conf_publish() once every registered l-core passed a quiescent state.
+ * WARNING - Static function (cannot use outside of this file).
+ * NOTE - Must not be called while holding reconf_lock. Blocks the calling thread (not the l-cores) for a grace period.
+ * 
+ * @param old A pointer to the previous forwarding config (may be NULL).
+ * 
+ * @return Void
+**/
+static void dpdkc_fwd_conf_retire(struct dpdkc_fwd_conf *old)
+{
+    unsigned int self = rte_lcore_id();
+    int online;
 
-    ret.err_num = (num > 0) ? 0 : -1;
+    if (old == NULL)
+    {
+        return;
+    }
 
-    if (ret.err_num != 0)
+    if (port_qsbr != NULL)
     {
-        ret.gen_msg = "No available ports.";
+        // An l-core retiring from its own loop goes offline while it waits so l-cores retiring at the same time don't wait on each other.
+        online = (self < RTE_MAX_LCORE && lcore_qsbr_online[self]);
 
-        return ret;
-    }
+        if (online)
+        {
+            rte_rcu_qsbr_thread_offline(port_qsbr, self);
+        }
 
-    // Store value in global variable.
-    nb_ports = num;
+        rte_rcu_qsbr_synchronize(port_qsbr, RTE_QSBR_THRID_INVALID);
 
-    // Also store value in data.
-    ret.data = num;
+        if (online)
+        {
+            rte_rcu_qsbr_thread_online(port_qsbr, self);
+        }
+    }
 
-    return ret;
+    dpdkc_fwd_conf_free(old);
 }
 
 /**
- * Checks all port pairs.
+ * Copies the published forwarding config (or builds one from lcore_port_conf[] and ports[] if none was published yet).
+ * WARNING - Static function (cannot use outside of this file).
+ * NOTE - The caller must hold reconf_lock.
  * 
- * @return The DPDK Common return structure (struct dpdkc_ret).
+ * @return A pointer to the copy or NULL if it couldn't be allocated (rte_errno is set).
 **/
-struct dpdkc_ret dpdkc_check_port_pairs()
+static struct dpdkc_fwd_conf *dpdkc_fwd_conf_copy()
 {
-    // Create DPDK Common's return structure.
-    struct dpdkc_ret ret = dpdkc_ret_init();
+    struct dpdkc_fwd_conf *conf = rte_malloc("fwd_conf", sizeof(*conf), RTE_CACHE_LINE_SIZE);
+    const struct dpdkc_fwd_conf *cur = dpdkc_fwd_conf_get();
+    unsigned int lcore;
+    int err = 0;
 
-    // If port params is NULL, ignore and return success.
-    if (port_pair_params != NULL)
+    if (conf == NULL)
     {
-        ret.err_num = dpdkc_check_port_pair_config().err_num;
+        dpdkc_set_err(-ENOMEM, "Failed to allocate forwarding config.");
+
+        return NULL;
     }
 
-    if (ret.err_num != 0)
+    if (cur != NULL)
     {
-        ret.gen_msg = "Failed to check port pair config.";
+        rte_memcpy(conf, cur, sizeof(*conf));
+
+        // The copy needs its own RX queue lists.
+        memset(conf->lcores, 0, sizeof(conf->lcores));
+
+        for (lcore = 0; lcore < RTE_MAX_LCORE && err == 0; lcore++)
+        {
+            err = dpdkc_lcore_map_copy(&conf->lcores[lcore], cur->lcores[lcore].rx_queue_list, cur->lcores[lcore].num_rx_queues);
+        }
+    }
+    else
+    {
+        err = dpdkc_fwd_conf_build(conf);
     }
 
-    return ret;
+    if (err != 0)
+    {
+        dpdkc_fwd_conf_free(conf);
+
+        dpdkc_set_err(-ENOMEM, "Failed to allocate forwarding config RX queue lists.");
+
+        return NULL;
+    }
+
+    return conf;
 }
 
 /**
- * Checks all ports against port mask.
+ * Republishes the forwarding config with the installed software flow rules.
+ * WARNING - Static function (cannot use outside of this file).
+ * NOTE - The caller must hold reconf_lock and pass the previous config to dpdkc_fwd_conf_retire() once it released the lock.
  * 
- * @return The DPDK Common return structure (struct dpdkc_ret).
+ * @param old Set to the previous forwarding config (or NULL).
+ * 
+ * @return 0 on success or a negative error number.
 **/
-struct dpdkc_ret dpdkc_ports_are_valid()
+static int dpdkc_fwd_conf_refresh_rules(struct dpdkc_fwd_conf **old)
 {
-    // Create DPDK Common's return structure.
-    struct dpdkc_ret ret = dpdkc_ret_init();
-    
-    ret.err_num = enabled_port_mask & ~((1 << nb_ports) - 1);
+    struct dpdkc_fwd_conf *conf;
 
-    if (ret.err_num != 0)
-    {
-        char msg[256];
-        snprintf(msg, sizeof(msg) - 1, "Number of ports failed against port mask. Try 0x%x.", (1 << nb_ports) - 1);
+    *old = NULL;
 
-        ret.gen_msg = strdup(msg);
+    if ((conf = dpdkc_fwd_conf_copy()) == NULL)
+    {
+        return -ENOMEM;
     }
 
-    return ret;
+    dpdkc_fwd_conf_build_rules(conf);
+    *old = dpdkc_fwd_conf_publish(conf);
+
+    return 0;
 }
 
 /**
- * Resets all destination ports.
+ * Publishes a forwarding config built from the l-core and port globals. Used before launching the built-in loops so changes made to the globals in between are picked up.
+ * WARNING - Static function (cannot use outside of this file).
  * 
- * @return Void
+ * @return 0 on success or a negative error number.
 **/
-void dpdkc_reset_dst_ports()
+static int dpdkc_fwd_conf_reset()
 {
-    // Loop through all ports and set them to 0.
-    for (port_id = 0; port_id < RTE_MAX_ETHPORTS; port_id++)
+    struct dpdkc_fwd_conf *conf = rte_malloc("fwd_conf", sizeof(*conf), RTE_CACHE_LINE_SIZE);
+    struct dpdkc_fwd_conf *old;
+
+    if (conf == NULL || dpdkc_fwd_conf_build(conf) != 0)
     {
-        ports[port_id].tx_port = 0;
+        dpdkc_fwd_conf_free(conf);
+
+        return dpdkc_set_err(-ENOMEM, "Failed to allocate forwarding config.");
     }
+
+    pthread_mutex_lock(&reconf_lock);
+    old = dpdkc_fwd_conf_publish(conf);
+    pthread_mutex_unlock(&reconf_lock);
+
+    dpdkc_fwd_conf_retire(old);
+
+    return 0;
 }
 
 /**
- * Populates all destination ports.
+ * Updates a port's state from its link (ports without LSC interrupts are always considered up). Removed ports stay removed.
+ * WARNING - Static function (cannot use outside of this file).
+ * NOTE - The caller must hold link_lock.
+ * 
+ * @param pid The port ID.
  * 
  * @return Void
 **/
-void dpdkc_populate_dst_ports()
+static void dpdkc_port_refresh_state(__u16 pid)
 {
-    // Number of ports in a mask.
-    unsigned nb_ports_in_mask = 0;
+    struct rte_eth_link link;
+    __u8 state = PORT_STATE_UP;
 
-    // The last port used.
-    __u16 last_port = 0;
+    if (__atomic_load_n(&ports[pid].state, __ATOMIC_RELAXED) == PORT_STATE_REMOVED)
+    {
+        return;
+    }
 
-    // Check port pair params first.
-    if (port_pair_params != NULL)
+    if (ports[pid].lsc_intr)
     {
-        // Specify index and p.
-        __u16 index;
-        __u16 p;
+        memset(&link, 0, sizeof(link));
 
-        // Loop through all port pair params.
-        for (index = 0; index < (nb_port_pair_params << 1); index++)
+        if (rte_eth_link_get_nowait(pid, &link) != 0 || link.link_status == RTE_ETH_LINK_DOWN)
         {
-            // Set port ID and dst port.
-            p = index & 1;
-            port_id = port_pair_params[index >> 1].port[p];
-            ports[port_id].tx_port = port_pair_params[index >> 1].port[p ^ 1];
-
-            // Set port config.
-            ports[port_id].rx = 1;
-            ports[ports[port_id].tx_port].tx = 1;
+            state = PORT_STATE_DOWN;
         }
     }
-    else
+
+    // Publish after everything the fast path needs for the port (e.g. TX buffers) is set up.
+    __atomic_store_n(&ports[pid].state, state, __ATOMIC_RELEASE);
+}
+
+/**
+ * Link status change (LSC) event callback. Updates the port's state and wakes anyone waiting in dpdkc_wait_link_up().
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param pid The port ID.
+ * @param type The event type.
+ * @param param The user parameter (unused).
+ * @param ret_param The event's parameter (unused).
+ * 
+ * @return 0
+**/
+static int dpdkc_lsc_event(__u16 pid, enum rte_eth_event_type type, void *param, void *ret_param)
+{
+    pthread_mutex_lock(&link_lock);
+
+    if (dpdkc_port_mask_test(enabled_port_mask, pid))
     {
-        // Loop through all ports.
-        RTE_ETH_FOREACH_DEV(port_id)
+        dpdkc_port_refresh_state(pid);
+
+        fprintf(stdout, "Port #%u link is %s.\n", pid, dpdkc_port_is_up(pid) ? "up" : "down");
+    }
+
+    pthread_cond_broadcast(&link_cond);
+    pthread_mutex_unlock(&link_lock);
+
+    return 0;
+}
+
+/**
+ * Closes and detaches a removed port once no l-core can still be using it. Runs on its own thread since waiting for the l-cores (and republishing the forwarding config when flushing flow rules) blocks.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param arg The port ID.
+ * 
+ * @return NULL
+**/
+static void *dpdkc_port_rmv_thread(void *arg)
+{
+    __u16 pid = (__u16)(uintptr_t)arg;
+    struct rte_eth_dev_info dev_info;
+    struct rte_eth_dev_tx_buffer *buffer;
+    struct rte_device *dev = NULL;
+    unsigned int lcore;
+
+    // Wait until every l-core passed a quiescent state after the port was marked removed.
+    if (port_qsbr != NULL)
+    {
+        rte_rcu_qsbr_synchronize(port_qsbr, RTE_QSBR_THRID_INVALID);
+    }
+
+    // Packets buffered for the port will never be sent.
+    for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++)
+    {
+        if ((buffer = lcore_port_conf[lcore].tx_buffer[pid]) != NULL && buffer->length > 0)
         {
-            // Check if port is 
-            if (!dpdkc_port_enabled())
+            rte_pktmbuf_free_bulk(buffer->pkts, buffer->length);
+
+            buffer->length = 0;
+        }
+    }
+
+    if (rte_eth_dev_info_get(pid, &dev_info) == 0)
+    {
+        dev = dev_info.device;
+    }
+
+    dpdkc_flow_rules_flush(pid);
+
+    rte_eth_dev_stop(pid);
+    rte_eth_dev_close(pid);
+
+    if (dev != NULL && rte_dev_remove(dev) != 0)
+    {
+        fprintf(stdout, "WARNING - Failed to detach the device of removed port #%u.\n", pid);
+    }
+
+    dpdkc_port_mask_clear(enabled_port_mask, pid);
+    __atomic_sub_fetch(&nb_ports_available, 1, __ATOMIC_RELAXED);
+
+    fprintf(stdout, "Port #%u removed.\n", pid);
+
+    __atomic_sub_fetch(&rmv_pending, 1, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+/**
+ * Hands a removed port's teardown to its own thread. Scheduled as an alarm by the removal event callback since ports can't be closed from within event callbacks and the EAL's interrupt thread mustn't block.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param arg The port ID.
+ * 
+ * @return Void
+**/
+static void dpdkc_port_rmv_alarm(void *arg)
+{
+    pthread_t tid;
+
+    if (pthread_create(&tid, NULL, dpdkc_port_rmv_thread, arg) != 0)
+    {
+        fprintf(stdout, "WARNING - Failed to create thread closing removed port #%u.\n", (__u16)(uintptr_t)arg);
+
+        __atomic_sub_fetch(&rmv_pending, 1, __ATOMIC_RELEASE);
+
+        return;
+    }
+
+    pthread_detach(tid);
+}
+
+/**
+ * Device removal (RMV) event callback. Marks the port removed so l-cores stop using it and schedules closing it.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param pid The port ID.
+ * @param type The event type.
+ * @param param The user parameter (unused).
+ * @param ret_param The event's parameter (unused).
+ * 
+ * @return 0
+**/
+static int dpdkc_rmv_event(__u16 pid, enum rte_eth_event_type type, void *param, void *ret_param)
+{
+    if (!dpdkc_port_mask_test(enabled_port_mask, pid))
+    {
+        return 0;
+    }
+
+    fprintf(stdout, "Port #%u device was removed. Closing port.\n", pid);
+
+    __atomic_store_n(&ports[pid].state, PORT_STATE_REMOVED, __ATOMIC_RELEASE);
+
+    __atomic_add_fetch(&rmv_pending, 1, __ATOMIC_RELAXED);
+
+    if (rte_eal_alarm_set(1, dpdkc_port_rmv_alarm, (void *)(uintptr_t)pid) != 0)
+    {
+        fprintf(stdout, "WARNING - Failed to schedule closing removed port #%u.\n", pid);
+
+        __atomic_sub_fetch(&rmv_pending, 1, __ATOMIC_RELAXED);
+    }
+
+    return 0;
+}
+
+/**
+ * Initializes a DPDK Common result type and returns it with default values.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret) with its default values.
+**/
+struct dpdkc_ret dpdkc_ret_init()
+{
+    struct dpdkc_ret ret =
+    {
+        .err_num = 0,
+        .gen_msg = NULL,
+        .port_id = -1,
+        .rx_id = -1,
+        .tx_id = -1,
+        .data = -1,
+        .dataptr = NULL
+    };
+
+    return ret;
+}
+
+/**
+ * Records an error like dpdkc_set_err() with a formatted detail. The detail is written to a per thread buffer, so nothing is allocated and it stays valid until the thread's next call.
+ * 
+ * @param err The negative error number.
+ * @param fmt The detail's format string.
+ * 
+ * @return The error number passed.
+**/
+int dpdkc_set_errf(int err, const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(RTE_PER_LCORE(dpdkc_errbuf), ERR_DETAIL_MAX, fmt, args);
+    va_end(args);
+
+    return dpdkc_set_err(err, RTE_PER_LCORE(dpdkc_errbuf));
+}
+
+/**
+ * Retrieves the detail of the calling thread's last datapath error.
+ * 
+ * @return The detail or "N/A" if none was recorded.
+**/
+const char *dpdkc_err_detail()
+{
+    return (RTE_PER_LCORE(dpdkc_errmsg) != NULL) ? RTE_PER_LCORE(dpdkc_errmsg) : "N/A";
+}
+
+/**
+ * Parses the port mask argument (hexadecimal of any length, e.g. 0xffffffffffffffff0 for ports 4-67) and stores it in the enabled_port_mask global variable.
+ * 
+ * @param arg A (const) pointer to the optarg variable from getopt.h.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The amount of ports enabled is stored in ret->data.
+**/
+struct dpdkc_ret dpdkc_parse_arg_port_mask(const char *arg)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    __u64 mask[PORT_MASK_WORDS] = {0};
+    const char *p;
+    size_t len;
+    unsigned int bit, nibble, i;
+
+    // Count the enabled ports from zero (ret.data defaults to -1).
+    ret.data = 0;
+
+    // Skip the optional prefix.
+    if (arg[0] == '0' && (arg[1] == 'x' || arg[1] == 'X'))
+    {
+        arg += 2;
+    }
+
+    if ((len = strlen(arg)) == 0)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Port mask is empty.";
+
+        return ret;
+    }
+
+    // Walk the digits from the lowest port up.
+    for (p = arg + len - 1, bit = 0; p >= arg; p--, bit += 4)
+    {
+        if (!isxdigit((unsigned char)*p))
+        {
+            ret.err_num = -EINVAL;
+            ret.gen_msg = "Port mask isn't hexadecimal.";
+
+            return ret;
+        }
+
+        nibble = isdigit((unsigned char)*p) ? *p - '0' : tolower((unsigned char)*p) - 'a' + 10;
+
+        for (i = 0; i < 4; i++)
+        {
+            if ((nibble & (1 << i)) == 0)
             {
                 continue;
             }
 
-            // Get remainder and assign dst ports.
-            if (nb_ports_in_mask % 2)
+            if (bit + i >= RTE_MAX_ETHPORTS)
             {
-                ports[port_id].tx_port = last_port;
-                ports[last_port].tx_port = port_id;
+                ret.err_num = -ERANGE;
+                ret.port_id = bit + i;
+                ret.gen_msg = "Port mask enables a port at or above RTE_MAX_ETHPORTS.";
 
-                // Make sure we set their port configs for TX.
-                ports[last_port].tx = 1;
-                ports[port_id].tx = 1;
-            }
-            else
-            {
-                last_port = port_id;
+                return ret;
             }
 
-            // Increase ports count.
-            nb_ports_in_mask++;
-        }
-
-        // If we have an odd number of ports in the port mask, output a warning.
-        if (nb_ports_in_mask % 2)
-        {
-            fprintf(stdout, "WARNING - Odd number of ports in port mask.\n");
-            ports[last_port].tx_port = last_port;
+            dpdkc_port_mask_set(mask, bit + i);
 
-            // Set port config (TX).
-            ports[last_port].tx = 1;
+            ret.data++;
         }
     }
+
+    // Store port mask in global port mask variable.
+    memcpy(enabled_port_mask, mask, sizeof(mask));
+
+    return ret;
 }
 
 /**
- * Maps ports and queues to each l-core.
+ * Parses a port list argument with IDs and ranges (e.g. 0-3,8,64-127) and stores it in the enabled_port_mask global variable.
  * 
- * @return The DPDK Common return structure (struct dpdkc_ret).
+ * @param arg A (const) pointer to the optarg variable from getopt.h.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The amount of ports enabled is stored in ret->data.
 **/
-struct dpdkc_ret dpdkc_ports_queues_mapping()
+struct dpdkc_ret dpdkc_parse_arg_port_list(const char *arg)
 {
     // Create DPDK Common's return structure.
     struct dpdkc_ret ret = dpdkc_ret_init();
+    __u64 mask[PORT_MASK_WORDS] = {0};
+    const char *p = arg;
+    char *end;
+    unsigned long first, last, pid;
 
-    // Pointer we'll be storing individual l-core configs in.
-    struct lcore_port_conf *qconf = NULL;
-
-    // L-core IDs.
-    unsigned int rx_lcore_id = 0;
-    unsigned int tx_lcore_id = 0;
+    // Count the enabled ports from zero (ret.data defaults to -1).
+    ret.data = 0;
 
-    // Map ports to l-core.
-    RTE_ETH_FOREACH_DEV(port_id)
+    while (*p != '\0')
     {
-        // Skip any ports not available.
-        if (!dpdkc_port_enabled())
+        errno = 0;
+
+        first = strtoul(p, &end, 10);
+
+        if (errno != 0 || end == p)
         {
-            continue;
+            ret.err_num = -EINVAL;
+            ret.gen_msg = "Port list entry isn't a number.";
+
+            return ret;
         }
 
-        // Handle RX ports.
-        if (ports[port_id].rx)
+        last = first;
+        p = end;
+
+        // Ranges are inclusive.
+        if (*p == '-')
         {
-            // If we've met the number of ports per l-core or the l-core is disabled, increase the ID.
-            if (lcore_port_conf[rx_lcore_id].num_rx_ports == rx_port_pl || rte_lcore_is_enabled(rx_lcore_id) == 0)
+            p++;
+
+            last = strtoul(p, &end, 10);
+
+            if (errno != 0 || end == p || last < first)
             {
-                // Increment the lcore ID.
-                rx_lcore_id++;
+                ret.err_num = -EINVAL;
+                ret.gen_msg = "Invalid port range in port list.";
+
+                return ret;
             }
 
-            // If the ID is higher or equal to the maximum lcore count, we need to exit with an error.
-            if (rx_lcore_id >= RTE_MAX_LCORE)
+            p = end;
+        }
+
+        if (last >= RTE_MAX_ETHPORTS)
+        {
+            ret.err_num = -ERANGE;
+            ret.port_id = last;
+            ret.gen_msg = "Port list contains a port at or above RTE_MAX_ETHPORTS.";
+
+            return ret;
+        }
+
+        for (pid = first; pid <= last; pid++)
+        {
+            if (!dpdkc_port_mask_test(mask, pid))
             {
-                ret.err_num = -1;
-                ret.gen_msg = "Failed due to l-core ID exceeding the maximum amount of l-cores.";
+                dpdkc_port_mask_set(mask, pid);
 
-                return ret;
+                ret.data++;
             }
+        }
 
-            // Assign pointer to make things easier.
-            qconf = &lcore_port_conf[rx_lcore_id];
+        if (*p == ',')
+        {
+            p++;
+        }
+        else if (*p != '\0')
+        {
+            ret.err_num = -EINVAL;
+            ret.gen_msg = "Port list entries must be separated by commas.";
+
+            return ret;
+        }
+    }
+
+    if (ret.data == 0)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Port list is empty.";
+
+        return ret;
+    }
+
+    // Store port mask in global port mask variable.
+    memcpy(enabled_port_mask, mask, sizeof(mask));
+
+    return ret;
+}
+
+/**
+ * Parses the port pair config.
+ * 
+ * @param arg A (const) pointer to the optarg variable from getopt.h.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_parse_arg_port_pair_config(const char *arg)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+
+    // For readability, we'll define these in an enum.s
+    enum fieldnames
+    {
+        FLD_PORT1 = 0,
+        FLD_PORT2,
+        _NUM_FLD
+    };
+
+    // This array holds the values (integers) of the port IDs to pair.
+    unsigned long int_fld[_NUM_FLD];
+
+    // This array holds the values (strings) of the port IDs to pair.
+    char *str_fld[_NUM_FLD];
+
+    // Useful pointers for parsing port pair.  
+    const char *p, *p0 = arg;
+
+    // Buffer for data in-between each () representing a port pair.
+    char s[256];
+    
+    // The size of the data in-between each () representing a port pair.
+    unsigned int size;
+    
+    // Pointer to use with str to unsigned long functions.
+    char *end;
+
+    // Variable for iterations.
+    int i;
+
+    // Set the number of port pair parameters to 0.s
+    nb_port_pair_params = 0;
+
+    // Loop through each value in format (x,y).
+    while ((p = strchr(p0, '(')) != NULL)
+    {
+        // Increase our address one.
+        p++;
+
+        // Now find the ending address where the ending ')' is.
+        p0 = strchr(p, ')');
+
+        // Check if we're NULL (otherwise may segfault).
+        if (p == NULL)
+        {
+            ret.err_num = -1;
+            ret.gen_msg = "Port pair variable p is NULL.";
+
+            return ret;
+        }
+
+        // Get the size of the pair values.
+        size = p0 - p;
+
+        // It should not be even close to 256 bytes.
+        if (size >= sizeof(s))
+        {
+            ret.err_num = -1;
+            ret.gen_msg = "Port pair data size exceeds 256 bytes (should never happen).";
+
+            return ret;
+        }
+
+        // Copy the port pair data to 's' char array.
+        memcpy(s, p, size);
+        
+        // Last byte should be 0x00.
+        s[size] = '\0';
+
+        // Split string by ',' which divides both integers for port pair.
+        if (rte_strsplit(s, sizeof(s), str_fld, _NUM_FLD, ',') != _NUM_FLD)
+        {
+            ret.err_num = -1;
+            ret.gen_msg = "Failed to split port pair data.";
+            
+            return ret;
+        }
+
+        // Loop through _NUM_FLD (should be 2).
+        for (i = 0; i < _NUM_FLD; i++)
+        {
+            // Resest error number.
+            errno = 0;
+
+            // Copy unsigned long to int_fld at i index.
+            int_fld[i] = strtoul(str_fld[i], &end, 0);
+            
+            // If error isn't empty, we're locaated at the ')' character or we exceed max ethernet ports, fail.
+            if (errno != 0 || end == str_fld[i] || int_fld[i] >= RTE_MAX_ETHPORTS)
+            {
+                ret.err_num = errno;
+                ret.gen_msg = "Error number present or reached out of port pair data.";
+                
+                return ret;
+            }
+        }
+
+        // Make sure we don't exceed max number of port pairs.
+        if (nb_port_pair_params >= RTE_MAX_ETHPORTS / 2)
+        {
+            ret.err_num = -1;
+            ret.gen_msg = "Exceeded maximum number of port pairs.";
+            
+            return ret;
+        }
+
+        // Assign port pair values (x, y) to port pair params array and increment number of port pairs.
+        port_pair_params_array[nb_port_pair_params].port[0] = (__u16)int_fld[FLD_PORT1];
+        port_pair_params_array[nb_port_pair_params].port[1] = (__u16)int_fld[FLD_PORT2];
+
+        nb_port_pair_params++;
+    }
+
+    // Assign port pair array to port pair params.
+    port_pair_params = port_pair_params_array;
+
+    // Success!
+    ret.err_num = 0;
+
+    return ret;
+}
+
+/**
+ * Parses the queue number argument and stores it in the global variable(s).
+ * 
+ * @param arg A (const) pointer to the optarg variable from getopt.h.
+ * @param rx Whether this is a RX queue count.
+ * @param tx Whether this is a TX queue count.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The amount of queues is stored in ret->data.
+**/
+struct dpdkc_ret dpdkc_parse_arg_queues(const char *arg, int rx, int tx)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+
+    // Initialize a couple necessary variables.
+    char *end = NULL;
+    unsigned long n;
+
+    // We must parse the hexadecimal.
+    n = strtol(arg, &end, 10);
+
+    // Check queue count.
+    if (n < 1)
+    {
+        ret.err_num = -1;
+        ret.gen_msg = "Amount of queues is below 0.";
+
+        return ret;
+    }
+
+    // Make sure we're not above max queue per port.
+    if ((rx && n > MAX_RX_QUEUES_PER_PORT) || (tx && n > MAX_TX_QUEUES_PER_PORT))
+    {
+        ret.err_num = -1;
+        ret.gen_msg = "Too many queues specified.";
+
+        return ret;
+    }
+
+    // Store in global variable.
+    if (rx)
+    {
+        rx_queue_pp = n;
+    }
+    else if (tx)
+    {
+        tx_queue_pp = n;
+    }
+
+    ret.data = n;
+
+    return ret;
+}
+
+/**
+ * Parses the statistics period argument and stores it in the stats_period global variable.
+ * 
+ * @param arg A (const) pointer to the optarg variable from getopt.h.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The period in seconds is stored in ret->data.
+**/
+struct dpdkc_ret dpdkc_parse_arg_stats_period(const char *arg)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+
+    char *end = NULL;
+    unsigned long n;
+
+    n = strtoul(arg, &end, 10);
+
+    // Make sure we parsed a number and it is within the max period.
+    if (end == arg || n > MAX_TIMER_PERIOD)
+    {
+        ret.err_num = -1;
+        ret.gen_msg = "Invalid statistics period.";
+
+        return ret;
+    }
+
+    stats_period = n;
+
+    ret.data = n;
+
+    return ret;
+}
+
+/**
+ * Parses an l-core list (e.g. "1,3-5") and assigns the l-cores a pipeline stage.
+ * 
+ * @param arg A (const) pointer to the optarg variable from getopt.h.
+ * @param role The pipeline stage (LCORE_ROLE_RX, LCORE_ROLE_WORKER or LCORE_ROLE_TX).
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The amount of l-cores assigned is stored in ret->data.
+**/
+struct dpdkc_ret dpdkc_parse_arg_pipeline(const char *arg, int role)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+
+    const char *p = arg;
+    char *end = NULL;
+    unsigned long first, last, i;
+
+    // Count the assigned l-cores from zero (ret.data defaults to -1).
+    ret.data = 0;
+
+    if (role != LCORE_ROLE_RX && role != LCORE_ROLE_WORKER && role != LCORE_ROLE_TX)
+    {
+        ret.err_num = -1;
+        ret.gen_msg = "Invalid pipeline role.";
+
+        return ret;
+    }
+
+    while (*p != '\0')
+    {
+        // Parse the first l-core of the range.
+        first = strtoul(p, &end, 10);
+
+        if (end == p)
+        {
+            ret.err_num = -1;
+            ret.gen_msg = "Invalid pipeline l-core list.";
+
+            return ret;
+        }
+
+        last = first;
+        p = end;
+
+        // Parse the end of the range if there is one.
+        if (*p == '-')
+        {
+            p++;
+            last = strtoul(p, &end, 10);
+
+            if (end == p || last < first)
+            {
+                ret.err_num = -1;
+                ret.gen_msg = "Invalid pipeline l-core range.";
+
+                return ret;
+            }
+
+            p = end;
+        }
+
+        for (i = first; i <= last; i++)
+        {
+            if (i >= RTE_MAX_LCORE || !rte_lcore_is_enabled(i))
+            {
+                ret.err_num = -1;
+                ret.data = i;
+                ret.gen_msg = "Pipeline l-core isn't enabled.";
+
+                return ret;
+            }
+
+            lcore_port_conf[i].role = role;
+            ret.data++;
+        }
+
+        if (*p == ',')
+        {
+            p++;
+        }
+        else if (*p != '\0')
+        {
+            ret.err_num = -1;
+            ret.gen_msg = "Invalid pipeline l-core list.";
+
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * Checks the port pair config after initialization.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_check_port_pair_config(void)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+
+    // Port pair config mask and port pair mask.
+    __u64 ppcm[PORT_MASK_WORDS] = {0};
+    __u64 ppm[PORT_MASK_WORDS];
+
+    // Other variables for iteration.
+    __u16 index; 
+    __u16 i; 
+    __u16 port_id;
+    unsigned int w;
+
+    // Loop through each port pair.
+    for (index = 0; index < nb_port_pair_params; index++)
+    {
+        // Reset port pair mask.
+        memset(ppm, 0, sizeof(ppm));
+
+        // Loop through max number of ports (likely 2).
+        for (i = 0; i < NUM_PORTS; i++)
+        {
+            // Retrieve the port ID (<i = 0>, <i = 1).
+            port_id = port_pair_params[index].port[i];
+
+            // Check if this port is enabled via the port mask.
+            if (!dpdkc_port_mask_test(enabled_port_mask, port_id))
+            {
+                ret.err_num = -1;
+                ret.port_id = port_id;
+                ret.gen_msg = "Port is not enabled in port mask.";
+
+                return ret;
+            }
+
+            // Check if the port is valid.
+            if (!rte_eth_dev_is_valid_port(port_id))
+            {
+                ret.err_num = -1;
+                ret.port_id = port_id;
+                ret.gen_msg = "Port is not valid.";
+
+                return ret;
+            }
+
+            // Retrieve port pair mask.
+            dpdkc_port_mask_set(ppm, port_id);
+        }
+
+        // Check if this port is being used in another pair since we OR the current PPM to the PPCM variable.
+        for (w = 0; w < PORT_MASK_WORDS; w++)
+        {
+            if (ppcm[w] & ppm[w])
+            {
+                ret.err_num = -1;
+                ret.port_id = port_id;
+                ret.gen_msg = "Port is being used by another port pair.";
+
+                return ret;
+            }
+        }
+
+        // OR PPM to PPCM so we can perform check above to ensure this port ID isn't in use with another port pair.
+        for (w = 0; w < PORT_MASK_WORDS; w++)
+        {
+            ppcm[w] |= ppm[w];
+        }
+    }
+
+    // Set global enabled port mask variable for use elsewhere and return 0 for success.
+    for (w = 0; w < PORT_MASK_WORDS; w++)
+    {
+        enabled_port_mask[w] &= ppcm[w];
+    }
+
+    // Return for success!
+    return ret;
+}
+
+/**
+ * Waits until every enabled port's link is up. Ports with LSC interrupts wake the wait through the LSC event callback while other ports are polled every LINK_POLL_MS milliseconds.
+ * 
+ * @param timeout_ms The max amount of milliseconds to wait.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The amount of ports up is stored in ret.data (ret.err_num is -ETIMEDOUT if any port is still down).
+**/
+struct dpdkc_ret dpdkc_wait_link_up(unsigned int timeout_ms)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    struct rte_eth_link link;
+    struct timespec abstime;
+    __u64 start_ns = dpdkc_now_ns(), deadline_ns = start_ns + (__u64)timeout_ms * NS_PER_S / MS_PER_S;
+    __u64 now_ns, wait_ns;
+    unsigned int nb_up, nb_down, all_lsc;
+    __u16 pid;
+
+    pthread_mutex_lock(&link_lock);
+
+    while (1)
+    {
+        nb_up = 0;
+        nb_down = 0;
+        all_lsc = 1;
+
+        RTE_ETH_FOREACH_DEV(pid)
+        {
+            if (!dpdkc_port_mask_test(enabled_port_mask, pid))
+            {
+                continue;
+            }
+
+            memset(&link, 0, sizeof(link));
+
+            if (rte_eth_link_get_nowait(pid, &link) == 0 && link.link_status == RTE_ETH_LINK_UP)
+            {
+                nb_up++;
+
+                continue;
+            }
+
+            nb_down++;
+            all_lsc &= ports[pid].lsc_intr;
+        }
+
+        now_ns = dpdkc_now_ns();
+
+        if (nb_down == 0 || quit || now_ns >= deadline_ns)
+        {
+            break;
+        }
+
+        // Sleep until the next LSC event. Poll ports without LSC interrupts instead.
+        wait_ns = deadline_ns - now_ns;
+
+        if (!all_lsc || !lsc_cb_registered)
+        {
+            wait_ns = RTE_MIN(wait_ns, (__u64)LINK_POLL_MS * NS_PER_S / MS_PER_S);
+        }
+
+        clock_gettime(CLOCK_REALTIME, &abstime);
+
+        wait_ns += abstime.tv_nsec;
+        abstime.tv_sec += wait_ns / NS_PER_S;
+        abstime.tv_nsec = wait_ns % NS_PER_S;
+
+        pthread_cond_timedwait(&link_cond, &link_lock, &abstime);
+    }
+
+    pthread_mutex_unlock(&link_lock);
+
+    init_phase_ns[INIT_PHASE_LINK] = dpdkc_now_ns() - start_ns;
+
+    if (nb_down > 0)
+    {
+        ret.err_num = -ETIMEDOUT;
+        ret.gen_msg = "Timed out waiting for links to come up.";
+    }
+
+    ret.data = nb_up;
+
+    return ret;
+}
+
+/**
+ * Checks and prints the status of all running ports (waiting up to MAX_CHECK_TIME * CHECK_INTERVAL milliseconds for their links to come up).
+ * 
+ * @return Void
+**/
+void dpdkc_check_link_status()
+{
+    // Initialize variables.
+    __u16 pid;
+    struct rte_eth_link link;
+    int ret;
+    char link_status_text[RTE_ETH_LINK_MAX_STR_LEN];
+
+    // Verbose output.
+    fprintf(stdout, "Checking link status...\n");
+    fflush(stdout);
+
+    dpdkc_wait_link_up(MAX_CHECK_TIME * CHECK_INTERVAL);
+
+    // If the program is supposed to exit, return.
+    if (quit)
+    {
+        return;
+    }
+
+    RTE_ETH_FOREACH_DEV(pid)
+    {
+        // Make sure this port is enabled through the port mask.
+        if (!dpdkc_port_mask_test(enabled_port_mask, pid))
+        {
+            continue;
+        }
+
+        // Clear the link by setting it to all 0x00 bytes.
+        memset(&link, 0, sizeof(link));
+
+        if ((ret = rte_eth_link_get_nowait(pid, &link)) < 0)
+        {
+            fprintf(stderr, "Port %u link failed: %s.\n", pid, rte_strerror(-ret));
+
+            continue;
+        }
+
+        rte_eth_link_to_str(link_status_text, sizeof(link_status_text), &link);
+        fprintf(stdout, "Port %d => %s.\n", pid, link_status_text);
+    }
+}
+
+/**
+ * Initializes the DPDK application's EAL.
+ * 
+ * @param argc The argument count.
+ * @param argv Pointer to arguments array.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_eal_init(int argc, char **argv)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    __u64 start_ns = dpdkc_now_ns();
+
+    int tmp = rte_eal_init(argc, argv);
+
+    init_phase_ns[INIT_PHASE_EAL] = dpdkc_now_ns() - start_ns;
+
+    if (tmp < 0)
+    {
+        ret.err_num = -1;
+        ret.gen_msg = "Failed to initialize EAL.";
+
+        return ret;
+    }
+
+    ret.data = tmp;
+
+    return ret;
+}
+
+/**
+ * Retrieves the amount of ports available.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). Number of available ports are stored inside of ret->data.
+**/
+struct dpdkc_ret dpdkc_get_nb_ports()
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+
+    unsigned short num = rte_eth_dev_count_avail();
+
+    ret.err_num = (num > 0) ? 0 : -1;
+
+    if (ret.err_num != 0)
+    {
+        ret.gen_msg = "No available ports.";
+
+        return ret;
+    }
+
+    // Store value in global variable.
+    nb_ports = num;
+
+    // Also store value in data.
+    ret.data = num;
+
+    return ret;
+}
+
+/**
+ * Checks all port pairs.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_check_port_pairs()
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+
+    // If port params is NULL, ignore and return success.
+    if (port_pair_params != NULL)
+    {
+        ret.err_num = dpdkc_check_port_pair_config().err_num;
+    }
+
+    if (ret.err_num != 0)
+    {
+        ret.gen_msg = "Failed to check port pair config.";
+    }
+
+    return ret;
+}
+
+/**
+ * Checks all ports against port mask.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_ports_are_valid()
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    unsigned int pid;
+
+    for (pid = nb_ports; pid < RTE_MAX_ETHPORTS; pid++)
+    {
+        if (!dpdkc_port_mask_test(enabled_port_mask, pid))
+        {
+            continue;
+        }
+
+        // Format into the thread's error buffer instead of allocating a message.
+        ret.err_num = dpdkc_set_errf(-EINVAL, "Port mask enables port #%u, but only %u ports are available.", pid, nb_ports);
+        ret.gen_msg = (char *)dpdkc_err_detail();
+        ret.port_id = pid;
+
+        break;
+    }
+
+    return ret;
+}
+
+/**
+ * Resets all destination ports.
+ * 
+ * @return Void
+**/
+void dpdkc_reset_dst_ports()
+{
+    __u16 pid;
+
+    // Loop through all ports and set them to 0.
+    for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++)
+    {
+        ports[pid].tx_port = 0;
+    }
+}
+
+/**
+ * Populates all destination ports.
+ * 
+ * @return Void
+**/
+void dpdkc_populate_dst_ports()
+{
+    // Number of ports in a mask.
+    unsigned nb_ports_in_mask = 0;
+    __u16 pid;
+
+    // The last port used.
+    __u16 last_port = 0;
+
+    // Check port pair params first.
+    if (port_pair_params != NULL)
+    {
+        // Specify index and p.
+        __u16 index;
+        __u16 p;
+
+        // Loop through all port pair params.
+        for (index = 0; index < (nb_port_pair_params << 1); index++)
+        {
+            // Set port ID and dst port.
+            p = index & 1;
+            pid = port_pair_params[index >> 1].port[p];
+            ports[pid].tx_port = port_pair_params[index >> 1].port[p ^ 1];
+
+            // Set port config.
+            ports[pid].rx = 1;
+            ports[ports[pid].tx_port].tx = 1;
+        }
+    }
+    else
+    {
+        // Loop through all ports.
+        RTE_ETH_FOREACH_DEV(pid)
+        {
+            // Check if port is 
+            if (!dpdkc_port_enabled(pid))
+            {
+                continue;
+            }
+
+            // Get remainder and assign dst ports.
+            if (nb_ports_in_mask % 2)
+            {
+                ports[pid].tx_port = last_port;
+                ports[last_port].tx_port = pid;
+
+                // Make sure we set their port configs for TX.
+                ports[last_port].tx = 1;
+                ports[pid].tx = 1;
+            }
+            else
+            {
+                last_port = pid;
+            }
+
+            // Every enabled port receives in this mode.
+            ports[pid].rx = 1;
+
+            // Increase ports count.
+            nb_ports_in_mask++;
+        }
+
+        // If we have an odd number of ports in the port mask, output a warning.
+        if (nb_ports_in_mask % 2)
+        {
+            fprintf(stdout, "WARNING - Odd number of ports in port mask.\n");
+            ports[last_port].tx_port = last_port;
+
+            // Set port config (TX).
+            ports[last_port].tx = 1;
+        }
+    }
+}
+
+/**
+ * Maps ports and queues to each l-core.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_ports_queues_mapping()
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    __u16 pid;
+
+    // Pointer we'll be storing individual l-core configs in.
+    struct lcore_port_conf *qconf = NULL;
+
+    // L-core IDs.
+    unsigned int rx_lcore_id = 0;
+    unsigned int tx_lcore_id = 0;
+
+    // Map ports to l-core.
+    RTE_ETH_FOREACH_DEV(pid)
+    {
+        // Skip any ports not available.
+        if (!dpdkc_port_enabled(pid))
+        {
+            continue;
+        }
+
+        // Handle RX ports.
+        if (ports[pid].rx)
+        {
+            // If we've met the number of ports per l-core or the l-core is disabled, increase the ID.
+            if (lcore_port_conf[rx_lcore_id].num_rx_ports == rx_port_pl || rte_lcore_is_enabled(rx_lcore_id) == 0)
+            {
+                // Increment the lcore ID.
+                rx_lcore_id++;
+            }
+
+            // If the ID is higher or equal to the maximum lcore count, we need to exit with an error.
+            if (rx_lcore_id >= RTE_MAX_LCORE)
+            {
+                ret.err_num = -1;
+                ret.gen_msg = "Failed due to l-core ID exceeding the maximum amount of l-cores.";
+
+                return ret;
+            }
+
+            // Assign pointer to make things easier.
+            qconf = &lcore_port_conf[rx_lcore_id];
+
+            // Assign the port ID and increment count. Each RX port is polled on its first queue in this mode.
+            if (dpdkc_lcore_add_port(qconf, pid, 0) != 0 || dpdkc_lcore_add_rx_queue(qconf, pid, 0) != 0)
+            {
+                ret.err_num = -ENOMEM;
+                ret.port_id = pid;
+                ret.gen_msg = "Failed to grow an l-core's RX lists.";
+
+                return ret;
+            }
+        }
+
+        // Handle TX ports.
+        if (ports[pid].tx)
+        {
+            // If we've met the number of ports per l-core or the l-core is disabled, increase the ID.
+            if (lcore_port_conf[tx_lcore_id].num_tx_ports == tx_port_pl || rte_lcore_is_enabled(rx_lcore_id) == 0)
+            {
+                // Increment the lcore ID.
+                tx_lcore_id++;
+            }
+
+            // If the ID is higher or equal to the maximum lcore count, we need to exit with an error.
+            if (tx_lcore_id >= RTE_MAX_LCORE)
+            {
+                ret.err_num = -1;
+                ret.gen_msg = "Failed due to l-core ID exceeding the maximum amount of l-cores.";
+
+                return ret;
+            }
+
+            // Assign pointer to make things easier.
+            qconf = &lcore_port_conf[tx_lcore_id];
+
+            // Assign the port ID and increment count.
+            if (dpdkc_lcore_add_port(qconf, pid, 1) != 0)
+            {
+                ret.err_num = -ENOMEM;
+                ret.port_id = pid;
+                ret.gen_msg = "Failed to grow an l-core's TX port list.";
+
+                return ret;
+            }
+
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * Maps each (port, RX queue) pair to enabled l-cores in a round-robin fashion and gives every enabled l-core its own TX queue.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The amount of TX queues required per port is stored in ret->data.
+**/
+struct dpdkc_ret dpdkc_ports_queues_mapping_rss()
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    __u16 pid;
+    unsigned int lcore;
+
+    // Pointer we'll be storing individual l-core configs in.
+    struct lcore_port_conf *qconf = NULL;
+
+    // The l-core the next queue is assigned to.
+    unsigned int rx_lcore_id;
+
+    // The amount of TX queues handed out.
+    __u16 nb_tx_queues = 0;
+
+    // Queue iterator.
+    __u16 queue_id;
+
+    // Give each enabled l-core its own TX queue so no two l-cores ever transmit on the same queue.
+    RTE_LCORE_FOREACH(lcore)
+    {
+        lcore_port_conf[lcore].tx_queue_id = nb_tx_queues++;
+    }
+
+    // Start at the first enabled l-core (including the main l-core).
+    rx_lcore_id = rte_get_next_lcore(-1, 0, 1);
+
+    RTE_ETH_FOREACH_DEV(pid)
+    {
+        // Skip any ports not available or not receiving.
+        if (!dpdkc_port_enabled(pid) || !ports[pid].rx)
+        {
+            continue;
+        }
+
+        for (queue_id = 0; queue_id < rx_queue_pp; queue_id++)
+        {
+            qconf = &lcore_port_conf[rx_lcore_id];
+
+            // The l-core's lists grow as needed.
+            if (dpdkc_lcore_add_rx_queue(qconf, pid, queue_id) != 0)
+            {
+                ret.err_num = -ENOMEM;
+                ret.port_id = pid;
+                ret.rx_id = queue_id;
+                ret.gen_msg = "Failed to grow an l-core's RX queue list.";
+
+                return ret;
+            }
+
+            // Keep the port list in sync for anything still iterating RX ports.
+            if ((qconf->num_rx_ports == 0 || qconf->rx_port_list[qconf->num_rx_ports - 1] != pid) && dpdkc_lcore_add_port(qconf, pid, 0) != 0)
+            {
+                ret.err_num = -ENOMEM;
+                ret.port_id = pid;
+                ret.gen_msg = "Failed to grow an l-core's RX port list.";
+
+                return ret;
+            }
+
+            // Move onto the next enabled l-core (wrapping around).
+            rx_lcore_id = rte_get_next_lcore(rx_lcore_id, 0, 1);
+        }
+    }
+
+    ret.data = nb_tx_queues;
+
+    return ret;
+}
+
+/**
+ * Maps ports and queues for pipeline mode (see dpdkc_parse_arg_pipeline()). Every (port, queue) pair is spread across the RX l-cores and each TX l-core gets its own TX queue on every port.
+ * NOTE - dpdkc_ports_queues_init() must be called with at least ret.data TX queues.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The amount of TX queues required is stored in ret.data.
+**/
+struct dpdkc_ret dpdkc_pipeline_mapping()
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    __u16 pid;
+    unsigned int lcore;
+
+    // Pointer we'll be storing individual l-core configs in.
+    struct lcore_port_conf *qconf = NULL;
+
+    // The RX l-cores in mapping order.
+    unsigned int rx_lcores[RTE_MAX_LCORE];
+    unsigned int nb_rx_lcores = 0, next_rx = 0;
+
+    // Queue iterator.
+    __u16 queue_id;
+
+    nb_pipeline_workers = 0;
+    nb_pipeline_tx_lcores = 0;
+
+    // Collect the l-cores of each stage and give each TX l-core its own TX queue.
+    RTE_LCORE_FOREACH(lcore)
+    {
+        qconf = &lcore_port_conf[lcore];
+
+        if (qconf->role == LCORE_ROLE_RX)
+        {
+            rx_lcores[nb_rx_lcores++] = lcore;
+        }
+        else if (qconf->role == LCORE_ROLE_WORKER)
+        {
+            pipeline_workers[nb_pipeline_workers++] = lcore;
+        }
+        else if (qconf->role == LCORE_ROLE_TX)
+        {
+            qconf->tx_queue_id = nb_pipeline_tx_lcores;
+            pipeline_tx_lcores[nb_pipeline_tx_lcores++] = lcore;
+        }
+    }
+
+    if (nb_rx_lcores == 0 || nb_pipeline_workers == 0 || nb_pipeline_tx_lcores == 0)
+    {
+        ret.err_num = -1;
+        ret.gen_msg = "Pipeline mode needs at least one RX, worker and TX l-core.";
+
+        return ret;
+    }
+
+    RTE_ETH_FOREACH_DEV(pid)
+    {
+        // Skip any ports not available or not receiving.
+        if (!dpdkc_port_enabled(pid) || !ports[pid].rx)
+        {
+            continue;
+        }
+
+        for (queue_id = 0; queue_id < rx_queue_pp; queue_id++)
+        {
+            qconf = &lcore_port_conf[rx_lcores[next_rx]];
+
+            // The l-core's queue list grows as needed.
+            if (dpdkc_lcore_add_rx_queue(qconf, pid, queue_id) != 0)
+            {
+                ret.err_num = -ENOMEM;
+                ret.port_id = pid;
+                ret.rx_id = queue_id;
+                ret.gen_msg = "Failed to grow an l-core's RX queue list.";
+
+                return ret;
+            }
+
+            // Move onto the next RX l-core (wrapping around).
+            next_rx = (next_rx + 1) % nb_rx_lcores;
+        }
+    }
+
+    ret.data = nb_pipeline_tx_lcores;
+
+    return ret;
+}
+
+/**
+ * Requests hardware offloads for a port. Desired offloads are enabled if the device supports them while initialization fails if a required offload isn't supported.
+ * Must be called before dpdkc_ports_queues_init(). Ports without a request use TX_OFFLOADS_DESIRED_DEFAULT.
+ * 
+ * @param pid The port ID (-1 applies the request to all ports).
+ * @param rx_desired The desired RX offloads (RTE_ETH_RX_OFFLOAD_*).
+ * @param rx_required The required RX offloads (RTE_ETH_RX_OFFLOAD_*).
+ * @param tx_desired The desired TX offloads (RTE_ETH_TX_OFFLOAD_*).
+ * @param tx_required The required TX offloads (RTE_ETH_TX_OFFLOAD_*).
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_request_offloads(int pid, __u64 rx_desired, __u64 rx_required, __u64 tx_desired, __u64 tx_required)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    int i, start = pid, end = pid;
+
+    if (pid >= RTE_MAX_ETHPORTS)
+    {
+        ret.err_num = -1;
+        ret.port_id = pid;
+        ret.gen_msg = "Port ID out of range for offload request.";
+
+        return ret;
+    }
+
+    // Apply to every port if requested.
+    if (pid < 0)
+    {
+        start = 0;
+        end = RTE_MAX_ETHPORTS - 1;
+    }
+
+    for (i = start; i <= end; i++)
+    {
+        ports[i].offloads_set = 1;
+        ports[i].rx_offloads_desired = rx_desired;
+        ports[i].rx_offloads_required = rx_required;
+        ports[i].tx_offloads_desired = tx_desired;
+        ports[i].tx_offloads_required = tx_required;
+    }
+
+    return ret;
+}
+
+/**
+ * Intersects a port's requested offloads with the device's capabilities and applies them to the port configuration.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param pid The port ID.
+ * @param dev_info A pointer to the port's device info.
+ * @param conf A pointer to the port configuration to apply the offloads to.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+static struct dpdkc_ret dpdkc_negotiate_offloads(__u16 pid, const struct rte_eth_dev_info *dev_info, struct rte_eth_conf *conf)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    struct port_conf *port = &ports[pid];
+    __u64 rx_want, tx_want;
+
+    if (!port->offloads_set)
+    {
+        port->rx_offloads_desired = 0;
+        port->rx_offloads_required = 0;
+        port->tx_offloads_desired = TX_OFFLOADS_DESIRED_DEFAULT;
+        port->tx_offloads_required = 0;
+    }
+
+    // Required offloads the device can't provide are fatal.
+    if ((port->rx_offloads_required & ~dev_info->rx_offload_capa) != 0)
+    {
+        fprintf(stdout, "Port #%u is missing required RX offloads 0x%llx.\n", pid, (unsigned long long)(port->rx_offloads_required & ~dev_info->rx_offload_capa));
+
+        ret.err_num = -ENOTSUP;
+        ret.port_id = pid;
+        ret.gen_msg = "Port doesn't support required RX offloads.";
+
+        return ret;
+    }
+
+    if ((port->tx_offloads_required & ~dev_info->tx_offload_capa) != 0)
+    {
+        fprintf(stdout, "Port #%u is missing required TX offloads 0x%llx.\n", pid, (unsigned long long)(port->tx_offloads_required & ~dev_info->tx_offload_capa));
+
+        ret.err_num = -ENOTSUP;
+        ret.port_id = pid;
+        ret.gen_msg = "Port doesn't support required TX offloads.";
+
+        return ret;
+    }
+
+    rx_want = port->rx_offloads_desired | port->rx_offloads_required;
+    tx_want = port->tx_offloads_desired | port->tx_offloads_required;
+
+    port->rx_offloads = rx_want & dev_info->rx_offload_capa;
+    port->tx_offloads = tx_want & dev_info->tx_offload_capa;
+
+    if (port->rx_offloads != rx_want || port->tx_offloads != tx_want)
+    {
+        fprintf(stdout, "WARNING - Port #%u doesn't support all desired offloads (RX missing 0x%llx, TX missing 0x%llx).\n", pid, (unsigned long long)(rx_want & ~port->rx_offloads), (unsigned long long)(tx_want & ~port->tx_offloads));
+    }
+
+    // LRO needs a maximum aggregated packet size.
+    if (port->rx_offloads & RTE_ETH_RX_OFFLOAD_TCP_LRO)
+    {
+        conf->rxmode.max_lro_pkt_size = dev_info->max_lro_pkt_size;
+    }
+
+    // Buffers from a pool with refcnt'd or indirect mbufs can't be fast freed.
+    if ((port->tx_offloads & RTE_ETH_TX_OFFLOAD_MBUF_FAST_FREE) && (port->tx_offloads & RTE_ETH_TX_OFFLOAD_MULTI_SEGS))
+    {
+        fprintf(stdout, "WARNING - Port #%u has MBUF_FAST_FREE and MULTI_SEGS enabled. All transmitted segments must come from one pool with a reference count of 1.\n", pid);
+    }
+
+    conf->rxmode.offloads |= port->rx_offloads;
+    conf->txmode.offloads |= port->tx_offloads;
+
+    return ret;
+}
+
+/**
+ * Sets the RSS hash key and hash functions used when a port is configured with more than one RX queue.
+ * 
+ * @param key A pointer to the RSS hash key (NULL uses the PMD's default key).
+ * @param key_len The length of the RSS hash key.
+ * @param hf The RSS hash functions (RTE_ETH_RSS_*) to request.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_set_rss(const __u8 *key, __u8 key_len, __u64 hf)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+
+    if (key != NULL && key_len > RSS_KEY_MAX_LEN)
+    {
+        ret.err_num = -1;
+        ret.gen_msg = "RSS hash key is too long.";
+
+        return ret;
+    }
+
+    if (key != NULL)
+    {
+        memcpy(rss_key, key, key_len);
+        rss_key_len = key_len;
+    }
+    else
+    {
+        rss_key_len = 0;
+    }
+
+    rss_hf = hf;
+
+    return ret;
+}
+
+/**
+ * Calculates the amount of mbufs a pool needs to serve the given ports and l-cores without starving.
+ * 
+ * @param nb_pool_ports The amount of ports receiving into and transmitting from the pool.
+ * @param nb_pool_lcores The amount of l-cores allocating from or freeing into the pool (local l-cores plus remote l-cores polling or transmitting on its ports).
+ * 
+ * @return The amount of mbufs.
+**/
+unsigned int dpdkc_calc_nb_mbufs(unsigned int nb_pool_ports, unsigned int nb_pool_lcores)
+{
+    unsigned int nb_mbufs = 0;
+
+    // Adaptive bursts may grow up to the max burst size.
+    unsigned int burst = adaptive_burst ? MAX_PCKT_BURST : packet_burst_size;
+
+    // Every RX and TX descriptor of every queue may hold an mbuf.
+    nb_mbufs += nb_pool_ports * (rx_queue_pp * nb_rxd + tx_queue_pp * nb_txd);
+
+    // Each l-core's mempool cache may hold up to its size (plus a burst when it overflows).
+    nb_mbufs += nb_pool_lcores * (MEMPOOL_CACHE_SIZE + burst);
+
+    // Each l-core has one RX burst in flight plus a TX buffer per port that may be partially filled.
+    nb_mbufs += nb_pool_lcores * burst * (1 + nb_ports);
+
+    // Headroom for the application.
+    nb_mbufs += mbuf_extra;
+
+    return nb_mbufs;
+}
+
+/**
+ * Creates a packet mbuf pool on every NUMA socket that has enabled ports or l-cores.
+ * NOTE - Call after mapping ports and queues to l-cores so remote l-cores using a socket's ports are reserved for.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The total pool memory in megabytes is stored in ret->data.
+**/
+struct dpdkc_ret dpdkc_create_mbuf()
+{
+    // Initialize return variable (custom error).
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    __u16 pid;
+    unsigned int lcore;
+
+    // Amount of ports and l-cores on each socket.
+    unsigned int socket_ports[RTE_MAX_NUMA_NODES] = {0};
+    unsigned int socket_lcores[RTE_MAX_NUMA_NODES] = {0};
+
+    unsigned int nb_mbufs;
+    unsigned int cache_size;
+    char name[RTE_MEMPOOL_NAMESIZE];
+    int socket_id;
+
+    // The size of a single mbuf object within the pool (header, private area, data room and mempool overhead).
+    __u32 obj_size = rte_mempool_calc_obj_size(sizeof(struct rte_mbuf) + mbuf_priv_size + mbuf_data_room, 0, NULL);
+    __u64 total_size = 0;
+    __u64 start_ns = dpdkc_now_ns();
+
+    // Count the enabled ports on each socket.
+    RTE_ETH_FOREACH_DEV(pid)
+    {
+        if (!dpdkc_port_enabled(pid))
+        {
+            continue;
+        }
+
+        socket_ports[dpdkc_port_socket(pid)]++;
+    }
+
+    // Count the enabled l-cores caching mbufs from each socket's pool (including remote l-cores polling or transmitting on its ports).
+    RTE_LCORE_FOREACH(lcore)
+    {
+        for (socket_id = 0; socket_id < RTE_MAX_NUMA_NODES; socket_id++)
+        {
+            if (dpdkc_lcore_uses_socket(lcore, socket_id))
+            {
+                socket_lcores[socket_id]++;
+            }
+        }
+    }
+
+    for (socket_id = 0; socket_id < RTE_MAX_NUMA_NODES; socket_id++)
+    {
+        // Only create pools on sockets that need one.
+        if (socket_ports[socket_id] == 0 && socket_lcores[socket_id] == 0)
+        {
+            continue;
+        }
+
+        // Retrieve amount of mbufs to create from the ports local to this socket and the l-cores using them.
+        nb_mbufs = dpdkc_calc_nb_mbufs(socket_ports[socket_id], socket_lcores[socket_id]);
+
+        // The mempool requires the cache size to be at most the pool size divided by 1.5.
+        cache_size = RTE_MIN(MEMPOOL_CACHE_SIZE, nb_mbufs * 2 / 3);
+
+        snprintf(name, sizeof(name), "pckt_pool_%d", socket_id);
+
+        // Create mbuf pool.
+        pcktmbuf_pools[socket_id] = rte_pktmbuf_pool_create(name, nb_mbufs, cache_size, mbuf_priv_size, mbuf_data_room, socket_id);
+
+        // Check if the mbuf pool is NULL.
+        if (pcktmbuf_pools[socket_id] == NULL)
+        {
+            ret.gen_msg = "Failed to create packet's mbuf pool.";
+            ret.err_num = -1;
+            ret.data = socket_id;
+
+            return ret;
+        }
+
+        fprintf(stdout, "Created mbuf pool on socket %d with %u mbufs of %u bytes => %.2f MB (%u ports, %u l-cores).\n", socket_id, nb_mbufs, obj_size, (double)nb_mbufs * obj_size / (1024 * 1024), socket_ports[socket_id], socket_lcores[socket_id]);
+
+        total_size += (__u64)nb_mbufs * obj_size;
+    }
+
+    // Report the total footprint so hugepages can be sized.
+    fprintf(stdout, "Total mbuf pool memory => %.2f MB.\n", (double)total_size / (1024 * 1024));
+
+    ret.data = total_size / (1024 * 1024);
+
+    // Keep the main pool pointing at the main l-core's socket.
+    pcktmbuf_pool = dpdkc_get_socket_pool(rte_socket_id());
+
+    // Bind every l-core to its local pool.
+    RTE_LCORE_FOREACH(lcore)
+    {
+        lcore_port_conf[lcore].pool = dpdkc_get_socket_pool(rte_lcore_to_socket_id(lcore));
+    }
+
+    init_phase_ns[INIT_PHASE_MBUF] = dpdkc_now_ns() - start_ns;
+
+    return ret;
+}
+
+/**
+ * Retrieves the packet mbuf pool of a NUMA socket.
+ * 
+ * @param socket_id The NUMA socket ID (SOCKET_ID_ANY returns the main pool).
+ * 
+ * @return A pointer to the socket's pool or the main pool if the socket has none.
+**/
+struct rte_mempool *dpdkc_get_socket_pool(int socket_id)
+{
+    if (socket_id < 0 || socket_id >= RTE_MAX_NUMA_NODES || pcktmbuf_pools[socket_id] == NULL)
+    {
+        return pcktmbuf_pool;
+    }
+
+    return pcktmbuf_pools[socket_id];
+}
+
+/**
+ * Takes packets an l-core's TX buffer couldn't send back out of its TX statistics, then hands them to the application's error callback or counts them in tx_dropped and frees them.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param unsent The packets the NIC didn't accept.
+ * @param count The amount of packets.
+ * @param userdata A pointer to the l-core's statistics.
+ * 
+ * @return Void
+**/
+static void dpdkc_tx_err_count(struct rte_mbuf **unsent, uint16_t count, void *userdata)
+{
+    struct dpdkc_lcore_stats *stats = userdata;
+    __u16 i;
+
+    // The forwarders count packets as sent when they're buffered.
+    stats->tx_pkts -= count;
+
+    for (i = 0; i < count; i++)
+    {
+        stats->tx_bytes -= rte_pktmbuf_pkt_len(unsent[i]);
+    }
+
+    if (tx_err_cb != NULL)
+    {
+        tx_err_cb(unsent, count, tx_err_userdata);
+
+        return;
+    }
+
+    stats->tx_dropped += count;
+
+    rte_pktmbuf_free_bulk(unsent, count);
+}
+
+/**
+ * Allocates an l-core's TX buffer for a port (unless it already has one) on the l-core's socket.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param lcore The l-core ID.
+ * @param pid The port ID.
+ * 
+ * @return 0 on success or -ENOMEM.
+**/
+static int dpdkc_lcore_tx_buffer_init(unsigned int lcore, __u16 pid)
+{
+    struct rte_eth_dev_tx_buffer *buffer;
+
+    if (lcore_port_conf[lcore].tx_buffer[pid] != NULL)
+    {
+        return 0;
+    }
+
+    // Leave room for adaptive bursts to grow the buffer's threshold (even if adaptive_burst is only turned on later).
+    buffer = rte_zmalloc_socket("tx_buffer", RTE_ETH_TX_BUFFER_SIZE(MAX_PCKT_BURST), 0, rte_lcore_to_socket_id(lcore));
+
+    if (buffer == NULL)
+    {
+        return -ENOMEM;
+    }
+
+    rte_eth_tx_buffer_init(buffer, packet_burst_size);
+
+    // Take packets the NIC didn't accept back out of the TX counters instead of silently freeing them.
+    rte_eth_tx_buffer_set_err_callback(buffer, dpdkc_tx_err_count, &lcore_stats[lcore]);
+
+    lcore_port_conf[lcore].tx_buffer[pid] = buffer;
+
+    return 0;
+}
+
+/**
+ * Initializes a single port along with its RX/TX queues and starts it.
+ * WARNING - Static function (cannot use outside of this file).
+ * NOTE - Safe to run for different ports on different l-cores at the same time (see parallel_port_init).
+ * 
+ * @param pid The port ID.
+ * @param promisc If 1, promisc mode is turned on for the port.
+ * @param rx_queues The amount of RX queues.
+ * @param tx_queues The amount of TX queues.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+static struct dpdkc_ret dpdkc_port_init(__u16 pid, int promisc, int rx_queues, int tx_queues)
+{
+    // Initialize return variable (custom error).
+    struct dpdkc_ret ret = dpdkc_ret_init();
+
+    // Initialize queue/port conifgs and device info.
+    int i;
+    
+    struct rte_eth_conf local_port_conf = port_conf;
+    struct rte_eth_dev_info dev_info;
+    __u64 phase_ns = dpdkc_now_ns();
+
+    // Initialize the port itself.
+    fprintf(stdout, "Initializing port #%u...\n", pid);
+    fflush(stdout);
+
+    // Attempt to receive device information for this specific port and check.
+    if ((ret.err_num = rte_eth_dev_info_get(pid, &dev_info)) != 0)
+    {
+        ret.port_id = pid;
+        ret.gen_msg = "Failed to retrieve device info.";
+
+        return ret;
+    }
+
+    // Negotiate the requested offloads with the device's capabilities.
+    ret = dpdkc_negotiate_offloads(pid, &dev_info, &local_port_conf);
+
+    if (ret.err_num != 0)
+    {
+        return ret;
+    }
+
+    // Enable RSS so packets are spread across all RX queues.
+    if (rx_queues > 1)
+    {
+        local_port_conf.rxmode.mq_mode = RTE_ETH_MQ_RX_RSS;
+        local_port_conf.rx_adv_conf.rss_conf.rss_hf = rss_hf & dev_info.flow_type_rss_offloads;
+        local_port_conf.rx_adv_conf.rss_conf.rss_key = NULL;
+        local_port_conf.rx_adv_conf.rss_conf.rss_key_len = 0;
+
+        if (rss_key_len > 0)
+        {
+            // The key must match the device's key size.
+            if (dev_info.hash_key_size != 0 && rss_key_len != dev_info.hash_key_size)
+            {
+                ret.err_num = -1;
+                ret.port_id = pid;
+                ret.gen_msg = "RSS hash key length doesn't match the device's key size.";
+
+                return ret;
+            }
+
+            local_port_conf.rx_adv_conf.rss_conf.rss_key = rss_key;
+            local_port_conf.rx_adv_conf.rss_conf.rss_key_len = rss_key_len;
+        }
+
+        if (local_port_conf.rx_adv_conf.rss_conf.rss_hf != rss_hf)
+        {
+            fprintf(stdout, "WARNING - Port #%u doesn't support all requested RSS hash functions (requested 0x%llx, using 0x%llx).\n", pid, (unsigned long long)rss_hf, (unsigned long long)local_port_conf.rx_adv_conf.rss_conf.rss_hf);
+        }
+
+        // Without any hash functions left, RSS can't be used.
+        if (local_port_conf.rx_adv_conf.rss_conf.rss_hf == 0)
+        {
+            fprintf(stdout, "WARNING - Port #%u has no usable RSS hash functions. Only the first RX queue will receive packets.\n", pid);
+
+            local_port_conf.rxmode.mq_mode = RTE_ETH_MQ_RX_NONE;
+        }
+
+        // Have the NIC store the RSS hash in each mbuf if it supports it.
+        if (dev_info.rx_offload_capa & RTE_ETH_RX_OFFLOAD_RSS_HASH)
+        {
+            local_port_conf.rxmode.offloads |= RTE_ETH_RX_OFFLOAD_RSS_HASH;
+            ports[pid].rx_offloads |= RTE_ETH_RX_OFFLOAD_RSS_HASH;
+        }
+    }
+
+    // Let link changes wake dpdkc_wait_link_up() instead of polling when the device supports LSC interrupts.
+    if (dev_info.dev_flags != NULL && (*dev_info.dev_flags & RTE_ETH_DEV_INTR_LSC))
+    {
+        local_port_conf.intr_conf.lsc = 1;
+    }
+
+    // Get notified when the device is removed (e.g. a VF is unplugged).
+    if (dev_info.dev_flags != NULL && (*dev_info.dev_flags & RTE_ETH_DEV_INTR_RMV))
+    {
+        local_port_conf.intr_conf.rmv = 1;
+    }
+
+    ports[pid].lsc_intr = local_port_conf.intr_conf.lsc;
+
+    // Configure the queues for this port.
+    if ((ret.err_num = rte_eth_dev_configure(pid, rx_queues, tx_queues, &local_port_conf)) < 0)
+    {
+        ret.port_id = pid;
+        ret.gen_msg = "Failed to configure ethernet device with RX and TX queues.";
+
+        return ret;
+    }
+
+    // Retrieve MAC address of device and store in array.
+    if ((ret.err_num = rte_eth_macaddr_get(pid, &ports[pid].mac)) < 0)
+    {
+        ret.port_id = pid;
+        ret.gen_msg = "Failed to retrieve MAC address on port.";
+
+        return ret;
+    }
+
+    port_init_ns[pid][PORT_PHASE_CONFIGURE] = dpdkc_now_ns() - phase_ns;
+    phase_ns = dpdkc_now_ns();
+
+    // Initialize the RX queues.
+    fflush(stdout);
+
+    for (i = 0; i < rx_queues; i++)
+    {
+        // Initialize RX config and set values from port configuration.
+        struct rte_eth_rxconf rxq_conf;
+
+        // Port offloads apply to every queue. Queue-only offloads are limited to the queue's capabilities.
+        rxq_conf = dev_info.default_rxconf;
+        rxq_conf.offloads = local_port_conf.rxmode.offloads & (dev_info.rx_offload_capa | dev_info.rx_queue_offload_capa);
+
+        // Setup the RX queue and check.
+        if ((ret.err_num = rte_eth_rx_queue_setup(pid, i, nb_rxd, rte_eth_dev_socket_id(pid), &rxq_conf, dpdkc_get_socket_pool(dpdkc_port_socket(pid)))) < 0)
+        {
+            ret.port_id = pid;
+            ret.rx_id = i;
+            ret.gen_msg = "Failed to setup RX queue.";
+
+            return ret;
+        }
+    }
+
+    // If we have more than one RX queue, set the port config (RX).
+    if (rx_queues > 0)
+    {
+        ports[pid].rx = 1;
+    }
+
+    // Initialize the TX queues.
+    fflush(stdout);
+
+    for (i = 0; i < tx_queues; i++)
+    {
+        // Initialize TX config and sset values from port configuration.
+        struct rte_eth_txconf txq_conf;
+
+        txq_conf = dev_info.default_txconf;
+        txq_conf.offloads = local_port_conf.txmode.offloads & (dev_info.tx_offload_capa | dev_info.tx_queue_offload_capa);
+
+        // Setup the TX queue and check.
+        if ((ret.err_num = rte_eth_tx_queue_setup(pid, i, nb_txd, rte_eth_dev_socket_id(pid), &txq_conf)) < 0)
+        {
+            ret.port_id = pid;
+            ret.tx_id = i;
+            ret.gen_msg = "Failed to setup TX queue.";
+
+            return ret;
+        }
+    }
+
+    // If we have more than one TX queue, set the port config TX.
+    if (tx_queues > 0)
+    {
+        ports[pid].tx = 1;
+
+        ports[pid].tx_buffer = rte_zmalloc_socket("tx_buffer", RTE_ETH_TX_BUFFER_SIZE(packet_burst_size), 0, rte_eth_dev_socket_id(pid));
+
+        // Check if the TX buffer allocation was successful.
+        if (ports[pid].tx_buffer  == NULL)
+        {
+            ret.err_num = -1;
+            ret.port_id = pid;
+            ret.gen_msg = "Failed to allocate TX buffer.";
+
+            return ret;
+        }
+
+        // Initialize the buffer itself within TX and check its result.
+        rte_eth_tx_buffer_init(ports[pid].tx_buffer , packet_burst_size);
+    }
+
+    port_init_ns[pid][PORT_PHASE_QUEUES] = dpdkc_now_ns() - phase_ns;
+    phase_ns = dpdkc_now_ns();
+
+    // We'll want to disable PType parsing.
+    if ((ret.err_num = rte_eth_dev_set_ptypes(pid, RTE_PTYPE_UNKNOWN, NULL, 0)) < 0)
+    {
+        ret.port_id = pid;
+        ret.gen_msg = "Failed to disable PType parsing for performance.";
+
+        return ret;
+    }
+
+    // Start the device itself.
+    if ((ret.err_num = rte_eth_dev_start(pid)) < 0)
+    {
+        ret.port_id = pid;
+        ret.gen_msg = "Failed to start device.";
+
+        return ret;
+    }
+
+    // Check for promiscuous mode.
+    if (promisc)
+    {
+        // If we aren't able to enable promiscuous mode, error out.
+        if ((ret.err_num = rte_eth_promiscuous_enable(pid)) < 0)
+        {
+            ret.port_id = pid;
+            ret.gen_msg = "Failed to enable promiscuous mode on port.";
+
+            return ret;
+        }
+    }
+
+    // Set verbose message.
+    fprintf(stdout, "Port #%d setup successfully with %d RX queues and %d TX queues. MAC Address => " RTE_ETHER_ADDR_PRT_FMT ".\n", pid, rx_queues, tx_queues, RTE_ETHER_ADDR_BYTES(&ports[pid].mac));
+    fprintf(stdout, "Port #%d offloads => RX 0x%llx, TX 0x%llx.\n", pid, (unsigned long long)ports[pid].rx_offloads, (unsigned long long)ports[pid].tx_offloads);
+
+    port_init_ns[pid][PORT_PHASE_START] = dpdkc_now_ns() - phase_ns;
+
+    return ret;
+}
+
+/**
+ * Initializes ports taken from the shared port list until it's empty. Ran on the main l-core and idle worker l-cores by dpdkc_ports_queues_init().
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param arg Unused.
+ * 
+ * @return 0 on exit.
+**/
+static int dpdkc_port_init_lcore(void *arg)
+{
+    unsigned int i;
+
+    while ((i = __atomic_fetch_add(&port_init_next, 1, __ATOMIC_RELAXED)) < nb_port_init_list)
+    {
+        port_init_rets[i] = dpdkc_port_init(port_init_list[i], port_init_promisc, port_init_rx_queues, port_init_tx_queues);
+    }
+
+    return 0;
+}
+
+/**
+ * Initializes all ports and RX/TX queues.
+ * NOTE - If parallel_port_init is set, ports are initialized on idle worker l-cores at the same time (call before launching anything on them).
+ * 
+ * @param promisc If 1, promisc mode is turned on for all ports/devices.
+ * @param rx_queues The amount of RX queues per port (recommend setting to 1).
+ * @param tx_queues The amount of TX queues per port (recommend setting to 1).
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_ports_queues_init(int promisc, int rx_queues, int tx_queues)
+{
+    // Initialize return variable (custom error).
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    __u8 launched[RTE_MAX_LCORE] = {0};
+    unsigned int i, lcore, nb_launched = 0;
+    __u64 start_ns = dpdkc_now_ns();
+    __u16 pid;
+
+    port_init_promisc = promisc;
+    port_init_rx_queues = rx_queues;
+    port_init_tx_queues = tx_queues;
+    port_init_next = 0;
+    nb_port_init_list = 0;
+
+    RTE_ETH_FOREACH_DEV(pid)
+    {
+        // Skip any ports not available.
+        if (!dpdkc_port_enabled(pid))
+        {
+            fprintf(stdout, "Skipping port #%u initialize due to it being disabled.\n", pid);
+            
+            continue;
+        }
+
+        // Increment the ports available count.
+        nb_ports_available++;
+
+        port_init_list[nb_port_init_list++] = pid;
+    }
+
+    // Removed ports are only closed after every l-core using ports passed a quiescent state.
+    if (port_qsbr == NULL)
+    {
+        port_qsbr = rte_zmalloc("port_qsbr", rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE), RTE_CACHE_LINE_SIZE);
+
+        if (port_qsbr == NULL || rte_rcu_qsbr_init(port_qsbr, RTE_MAX_LCORE) != 0)
+        {
+            rte_free(port_qsbr);
+            port_qsbr = NULL;
+
+            ret.err_num = -ENOMEM;
+            ret.gen_msg = "Failed to create port QSBR variable.";
+
+            return ret;
+        }
+    }
+
+    // Track link changes (registered before the ports start so no event is missed) and device removals.
+    if (!lsc_cb_registered && rte_eth_dev_callback_register(RTE_ETH_ALL, RTE_ETH_EVENT_INTR_LSC, dpdkc_lsc_event, NULL) == 0)
+    {
+        lsc_cb_registered = 1;
+    }
+
+    if (!rmv_cb_registered && rte_eth_dev_callback_register(RTE_ETH_ALL, RTE_ETH_EVENT_INTR_RMV, dpdkc_rmv_event, NULL) == 0)
+    {
+        rmv_cb_registered = 1;
+    }
+
+    // Hand ports out to idle worker l-cores (one port each at most) while the main l-core takes its share.
+    if (parallel_port_init)
+    {
+        RTE_LCORE_FOREACH_WORKER(lcore)
+        {
+            if (nb_launched + 1 >= nb_port_init_list)
+            {
+                break;
+            }
+
+            if (rte_eal_remote_launch(dpdkc_port_init_lcore, NULL, lcore) == 0)
+            {
+                launched[lcore] = 1;
+                nb_launched++;
+            }
+        }
+    }
+
+    dpdkc_port_init_lcore(NULL);
+
+    for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++)
+    {
+        if (launched[lcore])
+        {
+            rte_eal_wait_lcore(lcore);
+        }
+    }
+
+    // Report the first failure in port order.
+    for (i = 0; i < nb_port_init_list; i++)
+    {
+        if (port_init_rets[i].err_num != 0)
+        {
+            return port_init_rets[i];
+        }
+    }
+
+    // Allocate each polling l-core its own TX buffer for every TX port so l-cores never share a buffer.
+    RTE_LCORE_FOREACH(lcore)
+    {
+        struct lcore_port_conf *qconf = &lcore_port_conf[lcore];
+        unsigned int i;
+
+        // Pipeline TX l-cores transmit without polling any RX queues.
+        if (qconf->num_rx_queues == 0 && qconf->role != LCORE_ROLE_TX)
+        {
+            continue;
+        }
+
+        // Warn about ports polled from a remote socket since every packet then crosses the interconnect.
+        for (i = 0; i < qconf->num_rx_queues; i++)
+        {
+            if (dpdkc_port_socket(qconf->rx_queue_list[i].port_id) != (int)rte_lcore_to_socket_id(lcore))
+            {
+                fprintf(stdout, "WARNING - Port #%u (socket %d) is polled by l-core %u on remote socket %u.\n", qconf->rx_queue_list[i].port_id, dpdkc_port_socket(qconf->rx_queue_list[i].port_id), lcore, rte_lcore_to_socket_id(lcore));
+            }
+        }
+
+        // Pipeline RX l-cores hand packets off to rings instead of transmitting.
+        if (qconf->role == LCORE_ROLE_RX)
+        {
+            continue;
+        }
+
+        // The l-core's TX queue must exist on every port.
+        if (qconf->tx_queue_id >= tx_queues)
+        {
+            ret.err_num = -1;
+            ret.tx_id = qconf->tx_queue_id;
+            ret.gen_msg = "Not enough TX queues for the amount of polling l-cores.";
+
+            return ret;
+        }
+
+        RTE_ETH_FOREACH_DEV(pid)
+        {
+            if (!dpdkc_port_enabled(pid) || !ports[pid].tx)
+            {
+                continue;
+            }
+
+            if (dpdkc_lcore_tx_buffer_init(lcore, pid) != 0)
+            {
+                ret.err_num = -1;
+                ret.port_id = pid;
+                ret.gen_msg = "Failed to allocate l-core TX buffer.";
+
+                return ret;
+            }
+        }
+    }
+
+    // Publish each port's state now that the fast path has everything it needs.
+    pthread_mutex_lock(&link_lock);
+
+    for (i = 0; i < nb_port_init_list; i++)
+    {
+        dpdkc_port_refresh_state(port_init_list[i]);
+    }
+
+    pthread_mutex_unlock(&link_lock);
+
+    init_phase_ns[INIT_PHASE_PORTS] = dpdkc_now_ns() - start_ns;
+
+    // We're done!
+    return ret;
+}
+
+/**
+ * Initializes a port that was probed after dpdkc_ports_queues_init() (or re-initializes a removed port) with the same settings and adds it to the running l-cores. TX buffers are allocated on every transmitting l-core and each RX queue nobody polls yet is added to the polling l-core with the fewest RX queues.
+ * NOTE - New ports forward to themselves (set ports[].tx_port to change this).
+ * 
+ * @param pid The port ID.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_port_attach(__u16 pid)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    struct lcore_port_conf *qconf;
+    struct dpdkc_fwd_conf *conf;
+    struct dpdkc_lcore_map *map;
+    unsigned int lcore, best, j;
+    int q, polled, was_known;
+
+    ret.port_id = pid;
+
+    if (port_init_rx_queues == 0 && port_init_tx_queues == 0)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Initialize ports with dpdkc_ports_queues_init() before attaching ports.";
+
+        return ret;
+    }
+
+    if (pid >= RTE_MAX_ETHPORTS || !rte_eth_dev_is_valid_port(pid))
+    {
+        ret.err_num = -ENODEV;
+        ret.gen_msg = "Invalid port to attach.";
+
+        return ret;
+    }
+
+    was_known = ports[pid].rx || ports[pid].tx;
+
+    // Keep the fast path away from the port until it's set up.
+    __atomic_store_n(&ports[pid].state, PORT_STATE_DOWN, __ATOMIC_RELEASE);
+
+    ret = dpdkc_port_init(pid, port_init_promisc, port_init_rx_queues, port_init_tx_queues);
+
+    if (ret.err_num != 0)
+    {
+        return ret;
+    }
+
+    if (!was_known)
+    {
+        ports[pid].tx_port = pid;
+    }
+
+    // Every l-core that transmits needs a TX buffer for the port.
+    RTE_LCORE_FOREACH(lcore)
+    {
+        qconf = &lcore_port_conf[lcore];
+
+        if ((qconf->role == LCORE_ROLE_NONE && !dpdkc_lcore_polls(lcore)) || qconf->role == LCORE_ROLE_RX || !ports[pid].tx)
+        {
+            continue;
+        }
+
+        if (dpdkc_lcore_tx_buffer_init(lcore, pid) != 0)
+        {
+            ret.err_num = -ENOMEM;
+            ret.gen_msg = "Failed to allocate l-core TX buffer.";
+
+            return ret;
+        }
+    }
+
+    dpdkc_port_mask_set(enabled_port_mask, pid);
+    __atomic_add_fetch(&nb_ports_available, 1, __ATOMIC_RELAXED);
+
+    if ((conf = dpdkc_reconf_begin()) == NULL)
+    {
+        ret.err_num = -ENOMEM;
+        ret.gen_msg = "Failed to allocate forwarding config.";
+
+        return ret;
+    }
+
+    conf->tx_port[pid] = ports[pid].tx_port;
+
+    // Hand each RX queue nobody polls yet (a removed port's queues stay in their l-core's list) to the least loaded polling l-core.
+    for (q = 0; q < port_init_rx_queues; q++)
+    {
+        polled = 0;
+        best = RTE_MAX_LCORE;
+
+        RTE_LCORE_FOREACH(lcore)
+        {
+            map = &conf->lcores[lcore];
+
+            for (j = 0; j < map->num_rx_queues; j++)
+            {
+                if (map->rx_queue_list[j].port_id == pid && map->rx_queue_list[j].queue_id == q)
+                {
+                    polled = 1;
+                }
+            }
+
+            if ((lcore_port_conf[lcore].role == LCORE_ROLE_NONE && !dpdkc_lcore_polls(lcore)) || (lcore_port_conf[lcore].role != LCORE_ROLE_NONE && lcore_port_conf[lcore].role != LCORE_ROLE_RX))
+            {
+                continue;
+            }
+
+            if (best == RTE_MAX_LCORE || map->num_rx_queues < conf->lcores[best].num_rx_queues)
+            {
+                best = lcore;
+            }
+        }
+
+        if (polled)
+        {
+            continue;
+        }
+
+        if (best == RTE_MAX_LCORE)
+        {
+            fprintf(stdout, "WARNING - No polling l-core for port #%u RX queue %d.\n", pid, q);
+
+            continue;
+        }
+
+        if (dpdkc_lcore_map_add(&conf->lcores[best], pid, q) != 0)
+        {
+            dpdkc_reconf_abort(conf);
+
+            ret.err_num = -ENOMEM;
+            ret.gen_msg = "Failed to grow an l-core's RX queue list.";
+
+            return ret;
+        }
+
+        fprintf(stdout, "Port #%u RX queue %d => l-core %u.\n", pid, q, best);
+    }
+
+    ret = dpdkc_reconf_commit(conf);
+
+    if (ret.err_num != 0)
+    {
+        return ret;
+    }
+
+    pthread_mutex_lock(&link_lock);
+    dpdkc_port_refresh_state(pid);
+    pthread_mutex_unlock(&link_lock);
+
+    fprintf(stdout, "Port #%u attached (%s).\n", pid, dpdkc_port_is_up(pid) ? "up" : "down");
+
+    return ret;
+}
+
+/**
+ * Probes a hot-plugged device (e.g. a PCI address or virtual device arguments) and attaches every port it creates with dpdkc_port_attach() without stopping the l-cores.
+ * 
+ * @param devargs The device arguments.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The amount of ports attached is stored in ret.data.
+**/
+struct dpdkc_ret dpdkc_port_hotplug_add(const char *devargs)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    struct rte_dev_iterator it;
+    __u32 nb_attached = 0;
+    __u16 pid;
+
+    if ((ret.err_num = rte_dev_probe(devargs)) != 0)
+    {
+        ret.gen_msg = "Failed to probe hot-plugged device.";
+
+        return ret;
+    }
+
+    RTE_ETH_FOREACH_MATCHING_DEV(pid, devargs, &it)
+    {
+        ret = dpdkc_port_attach(pid);
+
+        if (ret.err_num != 0)
+        {
+            rte_eth_iterator_cleanup(&it);
+
+            return ret;
+        }
+
+        nb_attached++;
+    }
+
+    if (nb_attached == 0)
+    {
+        ret.err_num = -ENODEV;
+        ret.gen_msg = "Hot-plugged device has no ports.";
+    }
+
+    ret.data = nb_attached;
+
+    return ret;
+}
+
+/**
+ * Starts a live reconfiguration by copying the published forwarding config (or building one from lcore_port_conf[] and ports[] if none was published yet). Edit the copy's l-core RX queue lists (e.g. with dpdkc_reconf_move_queue()) and destination ports, then publish it with dpdkc_reconf_commit() or drop it with dpdkc_reconf_abort().
+ * NOTE - Only one reconfiguration may be in progress at a time. Software flow rules are taken from the installed rules on commit.
+ * 
+ * @return A pointer to the copy or NULL if it couldn't be allocated (rte_errno is set).
+**/
+struct dpdkc_fwd_conf *dpdkc_reconf_begin()
+{
+    struct dpdkc_fwd_conf *conf;
+
+    // Keep the published config from being replaced and freed while it's copied.
+    pthread_mutex_lock(&reconf_lock);
+    conf = dpdkc_fwd_conf_copy();
+    pthread_mutex_unlock(&reconf_lock);
+
+    return conf;
+}
+
+/**
+ * Moves an RX queue to another l-core in a forwarding config from dpdkc_reconf_begin() (or maps it if no l-core polls it yet).
+ * 
+ * @param conf A pointer to the forwarding config.
+ * @param pid The port ID.
+ * @param queue The RX queue ID.
+ * @param lcore The l-core ID that should poll the queue.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_reconf_move_queue(struct dpdkc_fwd_conf *conf, __u16 pid, __u16 queue, unsigned int lcore)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    struct dpdkc_lcore_map *map;
+    unsigned int l, i;
+
+    ret.port_id = pid;
+    ret.rx_id = queue;
+
+    if (lcore >= RTE_MAX_LCORE)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "L-core ID out of range.";
+
+        return ret;
+    }
+
+    // Take the queue away from the l-core polling it.
+    for (l = 0; l < RTE_MAX_LCORE; l++)
+    {
+        map = &conf->lcores[l];
+
+        for (i = 0; i < map->num_rx_queues; i++)
+        {
+            if (map->rx_queue_list[i].port_id != pid || map->rx_queue_list[i].queue_id != queue)
+            {
+                continue;
+            }
+
+            memmove(&map->rx_queue_list[i], &map->rx_queue_list[i + 1], sizeof(map->rx_queue_list[0]) * (map->num_rx_queues - i - 1));
+
+            map->num_rx_queues--;
+            i--;
+        }
+    }
+
+    if (dpdkc_lcore_map_add(&conf->lcores[lcore], pid, queue) != 0)
+    {
+        ret.err_num = -ENOMEM;
+        ret.gen_msg = "Failed to grow the l-core's RX queue list.";
+    }
+
+    return ret;
+}
+
+/**
+ * Validates and publishes a forwarding config from dpdkc_reconf_begin(). L-cores pick it up on their next loop without locking and the previous config is freed once every l-core passed a quiescent state. The config is mirrored into lcore_port_conf[] and ports[].tx_port.
+ * NOTE - Blocks the calling thread for a grace period. RX queues may only be given to l-cores that polled at launch (they have TX buffers) or pipeline RX l-cores.
+ * 
+ * @param conf A pointer to the forwarding config (freed on failure and owned by the library on success).
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_reconf_commit(struct dpdkc_fwd_conf *conf)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    struct dpdkc_lcore_map *map;
+    struct dpdkc_fwd_conf *old;
+    unsigned int lcore, role, i;
+    __u16 pid, queue;
+
+    pthread_mutex_lock(&reconf_lock);
+
+    memset(reconf_polled, 0, sizeof(reconf_polled));
+
+    for (lcore = 0; lcore < RTE_MAX_LCORE && ret.err_num == 0; lcore++)
+    {
+        map = &conf->lcores[lcore];
+        role = lcore_port_conf[lcore].role;
+
+        if (map->num_rx_queues == 0)
+        {
+            continue;
+        }
+
+        if (!rte_lcore_is_enabled(lcore) || (role != LCORE_ROLE_NONE && role != LCORE_ROLE_RX))
+        {
+            ret.err_num = -EINVAL;
+            ret.gen_msg = "RX queues mapped to an l-core that can't poll them.";
+
+            break;
+        }
+
+        for (i = 0; i < map->num_rx_queues; i++)
+        {
+            pid = map->rx_queue_list[i].port_id;
+            queue = map->rx_queue_list[i].queue_id;
+
+            ret.port_id = pid;
+            ret.rx_id = queue;
+
+            if (pid >= RTE_MAX_ETHPORTS || queue >= RTE_MAX_QUEUES_PER_PORT || !dpdkc_port_mask_test(enabled_port_mask, pid) || (int)queue >= port_init_rx_queues)
+            {
+                ret.err_num = -EINVAL;
+                ret.gen_msg = "RX queue mapped to a disabled port or a queue that doesn't exist.";
+
+                break;
+            }
+
+            if (reconf_polled[pid][queue]++)
+            {
+                ret.err_num = -EEXIST;
+                ret.gen_msg = "RX queue mapped to more than one l-core.";
+
+                break;
+            }
+
+            // Forwarding l-cores need a TX buffer for the destination port.
+            if (role == LCORE_ROLE_NONE && (conf->tx_port[pid] >= RTE_MAX_ETHPORTS || lcore_port_conf[lcore].tx_buffer[conf->tx_port[pid]] == NULL))
+            {
+                ret.err_num = -EINVAL;
+                ret.gen_msg = "L-core has no TX buffer for the port's destination (only l-cores polling at launch can take RX queues).";
+
+                break;
+            }
+        }
+    }
+
+    ret.port_id = -1;
+    ret.rx_id = -1;
+
+    // Make room in the globals describing the current mapping before publishing anything.
+    for (lcore = 0; lcore < RTE_MAX_LCORE && ret.err_num == 0; lcore++)
+    {
+        if (dpdkc_list_reserve((void **)&lcore_port_conf[lcore].rx_queue_list, &lcore_port_conf[lcore].max_rx_queues, conf->lcores[lcore].num_rx_queues, sizeof(struct lcore_rx_queue)) != 0)
+        {
+            ret.err_num = -ENOMEM;
+            ret.gen_msg = "Failed to grow an l-core's RX queue list.";
+        }
+    }
+
+    if (ret.err_num != 0)
+    {
+        pthread_mutex_unlock(&reconf_lock);
+
+        dpdkc_fwd_conf_free(conf);
+
+        return ret;
+    }
+
+    // Keep the globals describing the current mapping for the control plane.
+    for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++)
+    {
+        lcore_port_conf[lcore].num_rx_queues = conf->lcores[lcore].num_rx_queues;
+
+        if (conf->lcores[lcore].num_rx_queues > 0)
+        {
+            memcpy(lcore_port_conf[lcore].rx_queue_list, conf->lcores[lcore].rx_queue_list, sizeof(struct lcore_rx_queue) * conf->lcores[lcore].num_rx_queues);
+        }
+    }
+
+    for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++)
+    {
+        ports[pid].tx_port = conf->tx_port[pid];
+    }
+
+    dpdkc_fwd_conf_build_rules(conf);
+    old = dpdkc_fwd_conf_publish(conf);
+
+    pthread_mutex_unlock(&reconf_lock);
+
+    dpdkc_fwd_conf_retire(old);
+
+    return ret;
+}
+
+/**
+ * Drops a forwarding config from dpdkc_reconf_begin() without publishing it.
+ * 
+ * @param conf A pointer to the forwarding config.
+ * 
+ * @return Void
+**/
+void dpdkc_reconf_abort(struct dpdkc_fwd_conf *conf)
+{
+    dpdkc_fwd_conf_free(conf);
+}
+
+/**
+ * Registers the calling l-core with the library's QSBR variable. Port removals and forwarding config changes then wait until it reports a quiescent state. The built-in loops do this themselves.
+ * NOTE - Custom l-core loops using ports or calling dpdkc_flow_sw_filter() must call this before their loop, dpdkc_lcore_quiescent() once per loop and dpdkc_lcore_offline() on exit.
+ * 
+ * @return Void
+**/
+void dpdkc_lcore_online()
+{
+    if (port_qsbr != NULL && rte_lcore_id() < RTE_MAX_LCORE)
+    {
+        rte_rcu_qsbr_thread_register(port_qsbr, rte_lcore_id());
+        rte_rcu_qsbr_thread_online(port_qsbr, rte_lcore_id());
+
+        lcore_qsbr_online[rte_lcore_id()] = 1;
+    }
+}
+
+/**
+ * Unregisters the calling l-core from the library's QSBR variable.
+ * 
+ * @return Void
+**/
+void dpdkc_lcore_offline()
+{
+    if (port_qsbr != NULL && rte_lcore_id() < RTE_MAX_LCORE)
+    {
+        lcore_qsbr_online[rte_lcore_id()] = 0;
+
+        rte_rcu_qsbr_thread_offline(port_qsbr, rte_lcore_id());
+        rte_rcu_qsbr_thread_unregister(port_qsbr, rte_lcore_id());
+    }
+}
+
+/**
+ * Reports a quiescent state for the calling l-core (it holds no references to ports or the forwarding config). Call once per loop.
+ * 
+ * @return Void
+**/
+void dpdkc_lcore_quiescent()
+{
+    if (port_qsbr != NULL)
+    {
+        rte_rcu_qsbr_quiescent(port_qsbr, rte_lcore_id());
+    }
+}
+
+/**
+ * Check if the number of available ports is above one.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The amount of available ports is returned in ret->data.
+**/
+struct dpdkc_ret dpdkc_ports_available()
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+
+    // Check for error.
+    ret.err_num = !(nb_ports_available > 0);
+
+    if (ret.err_num != 0)
+    {
+        ret.gen_msg = "Number of available ports is 0. Make sure port mask is set correctly.";
+    }
+
+    ret.data = nb_ports_available;
+
+    return ret;
+}
+
+/**
+ * Retrieves the amount of l-cores that are enabled and stores it in nb_lcores variable.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The amount of available ports is returned in ret->data.
+**/
+struct dpdkc_ret dpdkc_get_available_lcore_count()
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    unsigned int lcore;
+
+    // Loop through each l-core.
+    RTE_LCORE_FOREACH(lcore)
+    {
+        // Check if it is enabled.
+        if (rte_lcore_is_enabled(lcore) == 0)
+        {
+            continue;
+        }
+
+        nb_lcores++;
+    }
+
+    // Check for none available l-cores.
+    ret.err_num = !(nb_lcores > 0);
+
+    if (ret.err_num != 0)
+    {
+        ret.gen_msg = "Number of enabled l-cores is 0.";
+    }
+
+    // Return number of l-cores in ret.data, but nb_lcores is also global.
+    ret.data = nb_lcores;
+
+    return ret;
+}
+
+/**
+ * Fills each enabled l-core's context from the l-core globals. The application data pointer is kept.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @return Void
+**/
+static void dpdkc_lcore_ctx_init()
+{
+    struct dpdkc_lcore_ctx *ctx;
+    unsigned int lcore;
+
+    RTE_LCORE_FOREACH(lcore)
+    {
+        ctx = &lcore_ctx[lcore];
+
+        ctx->lcore_id = lcore;
+        ctx->socket_id = rte_lcore_to_socket_id(lcore);
+        ctx->is_main = (lcore == rte_get_main_lcore());
+        ctx->tx_queue_id = lcore_port_conf[lcore].tx_queue_id;
+        ctx->conf = &lcore_port_conf[lcore];
+        ctx->stats = &lcore_stats[lcore];
+        ctx->arena = &lcore_arena[lcore];
+        ctx->pool = (lcore_port_conf[lcore].pool != NULL) ? lcore_port_conf[lcore].pool : pcktmbuf_pool;
+#ifdef USE_LATENCY_HIST
+        ctx->hist = &lcore_hist[lcore];
+#endif
+    }
+}
+
+/**
+ * Launches the DPDK application and waits for all l-cores to exit. A forwarding config is published from lcore_port_conf[] and ports[] first (see dpdkc_fwd_conf_get()).
+ * 
+ * @param f A pointer to the function to launch on all l-cores when ran. It receives a pointer to the l-core's context (struct dpdkc_lcore_ctx) as its argument.
+ * 
+ * @return Void
+**/
+void dpdkc_launch_and_run(void *f)
+{
+    int (*fn)(void *) = (int (*)(void *))f;
+    unsigned int lcore;
+
+    // Pick up the current l-core mapping, destination ports and software flow rules.
+    if (dpdkc_fwd_conf_reset() != 0)
+    {
+        fprintf(stderr, "Error publishing forwarding config :: %s.\n", dpdkc_err_detail());
+
+        return;
+    }
+
+    dpdkc_lcore_ctx_init();
+
+    // Launch the application on each worker l-core with its own context.
+    RTE_LCORE_FOREACH_WORKER(lcore)
+    {
+        if (rte_eal_remote_launch(fn, &lcore_ctx[lcore], lcore) != 0)
+        {
+            fprintf(stdout, "WARNING - Failed to launch on l-core %u.\n", lcore);
+        }
+    }
+
+    // Run on the main l-core as well.
+    fn(&lcore_ctx[rte_get_main_lcore()]);
+
+    RTE_LCORE_FOREACH_WORKER(lcore)
+    {
+        if (rte_eal_wait_lcore(lcore) < 0)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * Grows or shrinks an l-core's burst size (RX burst and TX buffer threshold) based on how full its recent bursts were.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param qconf A pointer to the l-core's config.
+ * @param burst The current burst size.
+ * @param nb_rx_total The amount of packets received over the window.
+ * @param nb_polls The amount of RX bursts over the window.
+ * 
+ * @return The new burst size.
+**/
+static __u16 dpdkc_adapt_burst(struct lcore_port_conf *qconf, __u16 burst, __u64 nb_rx_total, unsigned int nb_polls)
+{
+    struct rte_eth_dev_tx_buffer *buf;
+    __u64 capacity = (__u64)burst * nb_polls;
+    __u16 new_burst = burst;
+    __u16 pid;
+
+    // Mostly full bursts mean we're behind (larger bursts amortize per-call overhead). Mostly empty ones mean we only add latency.
+    if (nb_rx_total * 10 >= capacity * 9)
+    {
+        new_burst = RTE_MIN(burst * 2, MAX_PCKT_BURST);
+    }
+    else if (nb_rx_total * 4 < capacity)
+    {
+        new_burst = RTE_MAX(burst / 2, ADAPTIVE_BURST_MIN);
+    }
+
+    if (new_burst == burst)
+    {
+        return burst;
+    }
+
+    // Apply the new threshold to each of the l-core's TX buffers (flushing first if it already holds that many packets).
+    for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++)
+    {
+        // Buffers of removed ports are emptied once the port is closed.
+        if ((buf = qconf->tx_buffer[pid]) == NULL || __atomic_load_n(&ports[pid].state, __ATOMIC_ACQUIRE) == PORT_STATE_REMOVED)
+        {
+            continue;
+        }
+
+        if (buf->length >= new_burst)
+        {
+            rte_eth_tx_buffer_flush(pid, qconf->tx_queue_id, buf);
+        }
+
+        buf->size = new_burst;
+    }
+
+    return new_burst;
+}
+
+/**
+ * Backs off an idle l-core. Pauses at first, then sleeps (or waits on the RX queue with rte_power_monitor() if possible).
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param rxq A pointer to the l-core's first RX queue.
+ * @param idle_cnt The amount of consecutive empty poll loops.
+ * @param can_monitor Whether rte_power_monitor() may be used for the l-core's only RX queue.
+ * 
+ * @return Void
+**/
+static void dpdkc_idle_backoff(const struct lcore_rx_queue *rxq, unsigned int idle_cnt, int can_monitor)
+{
+    struct rte_power_monitor_cond pmc;
+
+    // Short idle periods only pause so we react quickly once traffic resumes.
+    if (idle_cnt < idle_poll_threshold * 2)
+    {
+        rte_pause();
+
+        return;
+    }
+
+    // Wake up as soon as the NIC writes the next RX descriptor (or after the sleep time passes).
+    if (can_monitor && rte_eth_get_monitor_addr(rxq->port_id, rxq->queue_id, &pmc) == 0)
+    {
+        rte_power_monitor(&pmc, rte_rdtsc() + rte_get_tsc_hz() / US_PER_S * idle_sleep_us);
+
+        return;
+    }
+
+    rte_delay_us_sleep(idle_sleep_us);
+}
+
+/**
+ * Sets the TX drain policy and deadline of an l-core's TX buffers (used by the built-in forwarder and the pipeline's TX stage). Buffers are always sent once full.
+ * 
+ * @param lcore The l-core ID (-1 applies to all l-cores).
+ * @param policy TX_DRAIN_FULL (only send full buffers), or TX_DRAIN_IDLE and/or TX_DRAIN_DEADLINE. TX_DRAIN_DEFAULT drains on a BURST_TX_DRAIN_US deadline.
+ * @param drain_us The drain deadline in microseconds (0 uses BURST_TX_DRAIN_US).
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The deadline in TSC cycles is stored in ret.data.
+**/
+struct dpdkc_ret dpdkc_set_tx_drain(int lcore, unsigned int policy, __u64 drain_us)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    __u64 drain_tsc;
+    unsigned int i;
+
+    if (lcore >= RTE_MAX_LCORE)
+    {
+        ret.err_num = -1;
+        ret.gen_msg = "L-core ID out of range for TX drain policy.";
+
+        return ret;
+    }
+
+    if ((policy & TX_DRAIN_FULL) && (policy & (TX_DRAIN_IDLE | TX_DRAIN_DEADLINE)))
+    {
+        ret.err_num = -1;
+        ret.gen_msg = "TX_DRAIN_FULL can't be combined with other drain policies.";
+
+        return ret;
+    }
+
+    // Convert to TSC cycles (rounded up).
+    drain_tsc = (rte_get_tsc_hz() + US_PER_S - 1) / US_PER_S * ((drain_us != 0) ? drain_us : BURST_TX_DRAIN_US);
+
+    for (i = 0; i < RTE_MAX_LCORE; i++)
+    {
+        if (lcore >= 0 && i != (unsigned int)lcore)
+        {
+            continue;
+        }
+
+        lcore_port_conf[i].tx_drain_policy = policy;
+        lcore_port_conf[i].tx_drain_tsc = drain_tsc;
+    }
+
+    ret.data = drain_tsc;
+
+    return ret;
+}
+
+/**
+ * Sets the callback called with packets an l-core's TX buffer couldn't send (e.g. to retry or recycle them). The callback owns the packets and they're no longer counted in tx_pkts and tx_bytes.
+ * NOTE - Must be called before dpdkc_ports_queues_init(). NULL restores the default, which counts the packets in tx_dropped and frees them.
+ * 
+ * @param cb The error callback.
+ * @param userdata The user data passed to the callback.
+ * 
+ * @return Void
+**/
+void dpdkc_set_tx_err_callback(buffer_tx_error_fn cb, void *userdata)
+{
+    tx_err_cb = cb;
+    tx_err_userdata = userdata;
+}
+
+/**
+ * Flushes all of an l-core's TX buffers on its TX queue.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param qconf A pointer to the l-core's config.
+ * @param stats A pointer to the l-core's statistics.
+ * 
+ * @return Void
+**/
+static inline void dpdkc_lcore_tx_flush(struct lcore_port_conf *qconf, struct dpdkc_lcore_stats *stats)
+{
+#ifdef USE_LATENCY_HIST
+    struct dpdkc_latency_hist *hist = &lcore_hist[rte_lcore_id()];
+#endif
+    __u16 pid;
+
+    RTE_ETH_FOREACH_DEV(pid)
+    {
+        // Buffers of removed ports are emptied once the port is closed.
+        if (qconf->tx_buffer[pid] == NULL || __atomic_load_n(&ports[pid].state, __ATOMIC_ACQUIRE) == PORT_STATE_REMOVED)
+        {
+            continue;
+        }
+
+        DPDKC_HIST_START(flush_start);
+
+        if (rte_eth_tx_buffer_flush(pid, qconf->tx_queue_id, qconf->tx_buffer[pid]) > 0)
+        {
+            stats->tx_flushes++;
+
+            DPDKC_HIST_RECORD(hist, HIST_TX_FLUSH, flush_start);
+        }
+    }
+}
+
+/**
+ * Prints statistics every stats_period seconds until quit is set. Used by the main l-core when it has nothing else to do.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @return Void
+**/
+static void dpdkc_stats_loop()
+{
+    const __u64 stats_period_tsc = rte_get_tsc_hz() * stats_period;
+    __u64 stats_tsc = 0, cur_tsc;
+
+    while (stats_period > 0 && !quit)
+    {
+        rte_delay_us_sleep(US_PER_S / 10);
+
+        cur_tsc = rte_rdtsc();
+
+        if (cur_tsc - stats_tsc > stats_period_tsc)
+        {
+            dpdkc_stats_print();
+
+            stats_tsc = cur_tsc;
+        }
+    }
+}
+
+/**
+ * The forwarding loop ran on each l-core by dpdkc_run_forwarder().
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param arg A pointer to the l-core's context.
+ * 
+ * @return 0 on exit.
+**/
+static int dpdkc_fwd_lcore(void *arg)
+{
+    struct dpdkc_lcore_ctx *ctx = arg;
+    struct rte_mbuf *pkts[MAX_PCKT_BURST];
+    struct lcore_port_conf *qconf;
+    const struct dpdkc_fwd_conf *conf;
+    const struct dpdkc_lcore_map *map;
+    struct dpdkc_lcore_stats *stats;
+    __u64 prev_tsc = 0, cur_tsc, stats_tsc = 0;
+    __u64 bytes;
+    unsigned int is_main;
+#ifdef USE_LATENCY_HIST
+    struct dpdkc_latency_hist *hist = ctx->hist;
+#endif
+    __u16 burst = RTE_MIN(packet_burst_size, MAX_PCKT_BURST);
+    __u16 nb_rx, nb_tx;
+    __u16 rx_port, rx_queue, dst_port, tx_queue;
+    unsigned int i, j;
+
+    // Adaptive burst and idle backoff state.
+    struct rte_cpu_intrinsics intrinsics;
+    __u64 window_rx = 0;
+    unsigned int window_polls = 0;
+    unsigned int idle_cnt = 0;
+    unsigned int loop_rx;
+    int can_monitor;
+
+    // Retrieve this l-core's config from its context.
+    qconf = ctx->conf;
+    stats = ctx->stats;
+
+    // Calculate the amount of TSC cycles between TX drains (BURST_TX_DRAIN_US rounded up unless set through dpdkc_set_tx_drain()).
+    const __u64 drain_tsc = (qconf->tx_drain_tsc != 0) ? qconf->tx_drain_tsc : (rte_get_tsc_hz() + US_PER_S - 1) / US_PER_S * BURST_TX_DRAIN_US;
+    const unsigned int drain_policy = (qconf->tx_drain_policy != TX_DRAIN_DEFAULT) ? qconf->tx_drain_policy : TX_DRAIN_DEADLINE;
+
+    // The main l-core prints statistics every stats_period seconds.
+    const __u64 stats_period_tsc = rte_get_tsc_hz() * stats_period;
+
+    is_main = ctx->is_main;
+
+    // Nothing to do on l-cores that didn't poll at launch (apart from reporting on the main l-core). Others stay in the loop since RX queues may be moved to them later.
+    if (!dpdkc_lcore_polls(ctx->lcore_id))
+    {
+        if (is_main)
+        {
+            dpdkc_stats_loop();
+        }
+
+        return 0;
+    }
+
+    // This l-core owns its TX queue on every port.
+    tx_queue = ctx->tx_queue_id;
+
+    // Power monitoring only watches a single address, so it requires a single RX queue (checked each loop) and CPU support.
+    rte_cpu_get_intrinsics_support(&intrinsics);
+
+    dpdkc_lcore_online();
+
+    while (!quit)
+    {
+        cur_tsc = rte_rdtsc();
+        loop_rx = 0;
+
+        // Ports and the forwarding config may change between loops.
+        dpdkc_lcore_quiescent();
+
+        conf = dpdkc_fwd_conf_get();
+        map = &conf->lcores[ctx->lcore_id];
+
+        can_monitor = idle_power_monitor && intrinsics.power_monitor && map->num_rx_queues == 1;
+
+        // Drain the TX buffers once the deadline passes so packets don't sit in a partial burst.
+        if (unlikely(cur_tsc - prev_tsc > drain_tsc))
+        {
+            if (drain_policy & TX_DRAIN_DEADLINE)
+            {
+                dpdkc_lcore_tx_flush(qconf, stats);
+            }
+
+            prev_tsc = cur_tsc;
+
+            // Report statistics from the main l-core.
+            if (unlikely(is_main && stats_period > 0 && cur_tsc - stats_tsc > stats_period_tsc))
+            {
+                dpdkc_stats_print();
+
+                stats_tsc = cur_tsc;
+            }
+        }
+
+        // Poll each (port, queue) pair mapped to this l-core.
+        for (i = 0; i < map->num_rx_queues; i++)
+        {
+            rx_port = map->rx_queue_list[i].port_id;
+            rx_queue = map->rx_queue_list[i].queue_id;
+
+            // Skip ports whose link is down or that were removed.
+            if (unlikely(!dpdkc_port_is_up(rx_port)))
+            {
+                continue;
+            }
+
+            DPDKC_HIST_START(rx_start);
+
+            nb_rx = rte_eth_rx_burst(rx_port, rx_queue, pkts, burst);
+
+            loop_rx += nb_rx;
+            window_rx += nb_rx;
+            window_polls++;
+
+            if (nb_rx == 0)
+            {
+                stats->empty_polls++;
+
+                continue;
+            }
+
+            DPDKC_HIST_RECORD(hist, HIST_RX_BURST, rx_start);
+
+            // Prefetch the packet data of the burst before handing it off so the callback doesn't stall on the first header reads.
+            bytes = 0;
+
+            for (j = 0; j < nb_rx; j++)
+            {
+                rte_prefetch0(rte_pktmbuf_mtod(pkts[j], void *));
+
+                bytes += rte_pktmbuf_pkt_len(pkts[j]);
+            }
+
+            stats->rx_pkts += nb_rx;
+            stats->rx_bytes += bytes;
+
+            dpdkc_capture_burst(pkts, nb_rx, CAPTURE_RX);
+
+            // Apply the software flow rules the NIC didn't take.
+            if (conf->nb_sw_rules[rx_port] > 0)
+            {
+                nb_tx = dpdkc_flow_sw_filter(rx_port, pkts, nb_rx);
+
+                stats->dropped += nb_rx - nb_tx;
+                nb_rx = nb_tx;
+
+                if (nb_rx == 0)
+                {
+                    continue;
+                }
+            }
+
+            // Let the application process the burst. Packets to forward are kept at the front of the array.
+            dpdkc_arena_reset();
+
+            DPDKC_HIST_START(cb_start);
+
+            nb_tx = (fwd_cb != NULL) ? fwd_cb(rx_port, pkts, nb_rx) : nb_rx;
+
+            DPDKC_HIST_RECORD(hist, HIST_CALLBACK, cb_start);
+
+            stats->dropped += nb_rx - nb_tx;
+
+            dpdkc_capture_burst(pkts, nb_tx, CAPTURE_TX);
+
+            dst_port = conf->tx_port[rx_port];
+
+            // Drop packets for a destination port that's down or removed.
+            if (unlikely(!dpdkc_port_is_up(dst_port)))
+            {
+                rte_pktmbuf_free_bulk(pkts, nb_tx);
+
+                stats->tx_dropped += nb_tx;
+
+                continue;
+            }
+
+            // Buffer packets to the destination port (sent once the buffer fills or on the next drain). Packets the NIC rejects are subtracted again by dpdkc_tx_err_count().
+            bytes = 0;
+
+            for (j = 0; j < nb_tx; j++)
+            {
+                bytes += rte_pktmbuf_pkt_len(pkts[j]);
+
+                if (rte_eth_tx_buffer(dst_port, tx_queue, qconf->tx_buffer[dst_port], pkts[j]) > 0)
+                {
+                    stats->tx_flushes++;
+                }
+            }
+
+            stats->tx_pkts += nb_tx;
+            stats->tx_bytes += bytes;
+        }
+
+        // Re-evaluate the burst size once per window.
+        if (adaptive_burst && window_polls >= ADAPTIVE_BURST_WINDOW)
+        {
+            burst = dpdkc_adapt_burst(qconf, burst, window_rx, window_polls);
+
+            window_rx = 0;
+            window_polls = 0;
+        }
+
+        // Send whatever is buffered once the RX queues run dry.
+        if ((drain_policy & TX_DRAIN_IDLE) && loop_rx == 0)
+        {
+            dpdkc_lcore_tx_flush(qconf, stats);
+        }
+
+        // Back off after too many consecutive empty loops.
+        if (loop_rx > 0)
+        {
+            idle_cnt = 0;
+        }
+        else if (idle_poll_threshold > 0 && ++idle_cnt >= idle_poll_threshold)
+        {
+            dpdkc_idle_backoff(&map->rx_queue_list[0], idle_cnt, can_monitor);
+
+            if (idle_cnt >= idle_poll_threshold * 2)
+            {
+                stats->idle_sleeps++;
+            }
+        }
+    }
+
+    // Don't leave packets behind in partial buffers.
+    dpdkc_lcore_tx_flush(qconf, stats);
+
+    dpdkc_lcore_offline();
+
+    return 0;
+}
+
+/**
+ * Launches the built-in run-to-completion forwarder on all l-cores and waits for them to exit.
+ * 
+ * @param cb The batch callback to call on each RX burst (NULL forwards everything). The callback must move packets it wants forwarded to the front of the array, free the rest and return how many are left.
+ * 
+ * @return Void
+**/
+void dpdkc_run_forwarder(dpdkc_batch_cb cb)
+{
+    fwd_cb = cb;
+
+    dpdkc_launch_and_run(dpdkc_fwd_lcore);
+}
+
+/**
+ * Creates the pipeline's rings (one input ring per worker and TX l-core) on each l-core's socket. Worker rings are filled by the RX l-cores and each worker feeds a fixed TX l-core so packets stay in order per worker.
+ * NOTE - Call after dpdkc_pipeline_mapping().
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_pipeline_init()
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    struct lcore_port_conf *qconf;
+    char name[RTE_RING_NAMESIZE];
+    unsigned int nb_rx_lcores = 0, nb_producers, flags, i;
+    unsigned int lcore;
+
+    RTE_LCORE_FOREACH(lcore)
+    {
+        if (lcore_port_conf[lcore].role == LCORE_ROLE_RX)
+        {
+            nb_rx_lcores++;
+        }
+    }
+
+    // Free rings from a previous run.
+    dpdkc_pipeline_free();
+
+    for (i = 0; i < nb_pipeline_workers; i++)
+    {
+        qconf = &lcore_port_conf[pipeline_workers[i]];
+
+        // Only a single RX l-core can use the cheaper single producer enqueue.
+        flags = RING_F_SC_DEQ | ((nb_rx_lcores == 1) ? RING_F_SP_ENQ : 0);
+
+        snprintf(name, sizeof(name), "pl_worker_%u", pipeline_workers[i]);
+
+        if ((qconf->in_ring = rte_ring_create(name, pipeline_ring_size, rte_lcore_to_socket_id(pipeline_workers[i]), flags)) == NULL)
+        {
+            ret.err_num = -rte_errno;
+            ret.data = pipeline_workers[i];
+            ret.gen_msg = "Failed to create pipeline worker ring.";
+
+            return ret;
+        }
+    }
+
+    for (i = 0; i < nb_pipeline_tx_lcores; i++)
+    {
+        qconf = &lcore_port_conf[pipeline_tx_lcores[i]];
+
+        // Workers are spread over TX l-cores in order (worker i feeds TX l-core i % nb_pipeline_tx_lcores).
+        nb_producers = nb_pipeline_workers / nb_pipeline_tx_lcores + (i < nb_pipeline_workers % nb_pipeline_tx_lcores);
+        flags = RING_F_SC_DEQ | ((nb_producers == 1) ? RING_F_SP_ENQ : 0);
+
+        snprintf(name, sizeof(name), "pl_tx_%u", pipeline_tx_lcores[i]);
+
+        if ((qconf->in_ring = rte_ring_create(name, pipeline_ring_size, rte_lcore_to_socket_id(pipeline_tx_lcores[i]), flags)) == NULL)
+        {
+            ret.err_num = -rte_errno;
+            ret.data = pipeline_tx_lcores[i];
+            ret.gen_msg = "Failed to create pipeline TX ring.";
+
+            return ret;
+        }
+    }
+
+    for (i = 0; i < nb_pipeline_workers; i++)
+    {
+        lcore_port_conf[pipeline_workers[i]].out_ring = lcore_port_conf[pipeline_tx_lcores[i % nb_pipeline_tx_lcores]].in_ring;
+    }
+
+    return ret;
+}
+
+/**
+ * Frees the pipeline's rings (packets still in them are freed).
+ * 
+ * @return Void
+**/
+void dpdkc_pipeline_free()
+{
+    struct lcore_port_conf *qconf;
+    struct rte_mbuf *m;
+    unsigned int lcore;
+
+    RTE_LCORE_FOREACH(lcore)
+    {
+        qconf = &lcore_port_conf[lcore];
+
+        if (qconf->in_ring != NULL)
+        {
+            while (rte_ring_dequeue(qconf->in_ring, (void **)&m) == 0)
+            {
+                rte_pktmbuf_free(m);
+            }
+
+            rte_ring_free(qconf->in_ring);
+        }
+
+        qconf->in_ring = NULL;
+        qconf->out_ring = NULL;
+    }
+}
+
+/**
+ * Hands a burst off to the pipeline's workers (whole bursts round-robin).
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param pkts A pointer to the burst's mbufs.
+ * @param nb_pkts The amount of packets.
+ * @param next_worker A pointer to the index of the next worker.
+ * @param stats A pointer to the l-core's statistics.
+ * 
+ * @return Void
+**/
+static void dpdkc_pipeline_distribute(struct rte_mbuf **pkts, __u16 nb_pkts, unsigned int *next_worker, struct dpdkc_lcore_stats *stats)
+{
+    struct rte_ring *ring = lcore_port_conf[pipeline_workers[*next_worker]].in_ring;
+    unsigned int n;
+
+    n = rte_ring_enqueue_burst(ring, (void * const *)pkts, nb_pkts, NULL);
+
+    // Drop what doesn't fit so RX never blocks on a slow worker.
+    if (unlikely(n < nb_pkts))
+    {
+        rte_pktmbuf_free_bulk(&pkts[n], nb_pkts - n);
+
+        stats->dropped += nb_pkts - n;
+    }
+
+    *next_worker = (*next_worker + 1) % nb_pipeline_workers;
+}
+
+/**
+ * Computes a flow hash for a packet. Uses the NIC's RSS hash if present, otherwise a symmetric software hash of the IP addresses and TCP/UDP ports (both directions of a flow hash the same).
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param m A pointer to the packet's mbuf.
+ * 
+ * @return The flow hash.
+**/
+static inline __u32 dpdkc_pkt_flow_hash(const struct rte_mbuf *m)
+{
+    const __u8 *data = rte_pktmbuf_mtod(m, const __u8 *);
+    const struct rte_ipv4_hdr *iph;
+    const struct rte_ipv6_hdr *ip6h;
+    const struct rte_udp_hdr *l4h;
+    const __u32 *words;
+    __u16 len = rte_pktmbuf_data_len(m);
+    __u16 ether_type, l4_off = 0;
+    __u32 h = 0;
+    __u8 proto = 0;
+    unsigned int i;
+
+    if (m->ol_flags & RTE_MBUF_F_RX_RSS_HASH)
+    {
+        return m->hash.rss;
+    }
+
+    if (len < sizeof(struct rte_ether_hdr))
+    {
+        return 0;
+    }
+
+    ether_type = ((const struct rte_ether_hdr *)data)->ether_type;
+
+    if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) && len >= sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv4_hdr))
+    {
+        iph = (const struct rte_ipv4_hdr *)(data + sizeof(struct rte_ether_hdr));
+
+        h = iph->src_addr ^ iph->dst_addr;
+        proto = iph->next_proto_id;
+
+        // Non-first fragments have no ports.
+        if ((iph->fragment_offset & rte_cpu_to_be_16(RTE_IPV4_HDR_OFFSET_MASK)) == 0)
+        {
+            l4_off = sizeof(struct rte_ether_hdr) + (iph->version_ihl & RTE_IPV4_HDR_IHL_MASK) * RTE_IPV4_IHL_MULTIPLIER;
+        }
+    }
+    else if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6) && len >= sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv6_hdr))
+    {
+        ip6h = (const struct rte_ipv6_hdr *)(data + sizeof(struct rte_ether_hdr));
+
+        // Fold the source and destination addresses (stored back to back).
+        words = (const __u32 *)((const __u8 *)ip6h + offsetof(struct rte_ipv6_hdr, src_addr));
+
+        for (i = 0; i < 8; i++)
+        {
+            h ^= words[i];
+        }
+
+        proto = ip6h->proto;
+        l4_off = sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv6_hdr);
+    }
+    else
+    {
+        return ether_type;
+    }
+
+    if ((proto == IPPROTO_TCP || proto == IPPROTO_UDP) && l4_off != 0 && l4_off + 4 <= len)
+    {
+        l4h = (const struct rte_udp_hdr *)(data + l4_off);
+
+        h ^= (__u32)(l4h->src_port ^ l4h->dst_port) << 16;
+    }
+
+    h ^= proto;
+
+    // Mix so the upper bits (used to pick the worker) depend on every input bit.
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    h ^= h >> 16;
+
+    return h;
+}
+
+/**
+ * Hands a burst off to the pipeline's workers by flow hash so every packet of a flow is processed by the same worker (and stays in order). Packets are grouped per worker with a stable counting sort and enqueued with one burst per worker.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param pkts A pointer to the burst's mbufs.
+ * @param nb_pkts The amount of packets.
+ * @param stats A pointer to the l-core's statistics.
+ * 
+ * @return Void
+**/
+static void dpdkc_pipeline_distribute_flows(struct rte_mbuf **pkts, __u16 nb_pkts, struct dpdkc_lcore_stats *stats)
+{
+    struct rte_mbuf *sorted[MAX_PCKT_BURST];
+    __u16 worker[MAX_PCKT_BURST];
+    __u16 offs[RTE_MAX_LCORE + 1];
+    unsigned int i, w, start, n;
+
+    memset(offs, 0, (nb_pipeline_workers + 1) * sizeof(offs[0]));
+
+    // Pick each packet's worker and count the packets per worker.
+    for (i = 0; i < nb_pkts; i++)
+    {
+        if (i + CLASSIFY_PREFETCH_OFFSET < nb_pkts)
+        {
+            rte_prefetch0(rte_pktmbuf_mtod(pkts[i + CLASSIFY_PREFETCH_OFFSET], void *));
+        }
+
+        worker[i] = ((__u64)dpdkc_pkt_flow_hash(pkts[i]) * nb_pipeline_workers) >> 32;
+        offs[worker[i] + 1]++;
+    }
+
+    // Turn the counts into each worker's start offset.
+    for (w = 1; w <= nb_pipeline_workers; w++)
+    {
+        offs[w] += offs[w - 1];
+    }
+
+    // Place the packets (keeping their order). Afterwards offs[w] is the end of worker w's packets.
+    for (i = 0; i < nb_pkts; i++)
+    {
+        sorted[offs[worker[i]]++] = pkts[i];
+    }
+
+    for (w = 0, start = 0; w < nb_pipeline_workers; start = offs[w], w++)
+    {
+        if (offs[w] == start)
+        {
+            continue;
+        }
+
+        n = rte_ring_enqueue_burst(lcore_port_conf[pipeline_workers[w]].in_ring, (void * const *)&sorted[start], offs[w] - start, NULL);
+
+        // Drop what doesn't fit so RX never blocks on a slow worker.
+        if (unlikely(start + n < offs[w]))
+        {
+            rte_pktmbuf_free_bulk(&sorted[start + n], offs[w] - start - n);
+
+            stats->dropped += offs[w] - start - n;
+        }
+    }
+}
+
+/**
+ * The pipeline's RX stage. Polls the l-core's RX queues and hands bursts to the workers.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param ctx A pointer to the l-core's context (the main l-core prints statistics).
+ * 
+ * @return Void
+**/
+static void dpdkc_pipeline_rx(struct dpdkc_lcore_ctx *ctx)
+{
+    struct dpdkc_lcore_stats *stats = ctx->stats;
+    struct rte_mbuf *pkts[MAX_PCKT_BURST];
+    const struct dpdkc_lcore_map *map;
+    __u16 burst = RTE_MIN(packet_burst_size, MAX_PCKT_BURST);
+    __u16 nb_rx, nb_keep, rx_port;
+    __u64 bytes, cur_tsc, stats_tsc = 0;
+    unsigned int next_worker = 0, idle_cnt = 0, loop_rx, i, j;
+
+    const __u64 stats_period_tsc = rte_get_tsc_hz() * stats_period;
+
+    // Start l-cores on different workers.
+    next_worker = ctx->lcore_id % nb_pipeline_workers;
+
+    while (!quit)
+    {
+        loop_rx = 0;
+
+        // Ports and the forwarding config may change between loops.
+        dpdkc_lcore_quiescent();
+
+        map = &dpdkc_fwd_conf_get()->lcores[ctx->lcore_id];
+
+        for (i = 0; i < map->num_rx_queues; i++)
+        {
+            rx_port = map->rx_queue_list[i].port_id;
+
+            // Skip ports whose link is down or that were removed.
+            if (unlikely(!dpdkc_port_is_up(rx_port)))
+            {
+                continue;
+            }
+
+            nb_rx = rte_eth_rx_burst(rx_port, map->rx_queue_list[i].queue_id, pkts, burst);
+
+            if (nb_rx == 0)
+            {
+                stats->empty_polls++;
+
+                continue;
+            }
+
+            loop_rx += nb_rx;
+            bytes = 0;
+
+            for (j = 0; j < nb_rx; j++)
+            {
+                bytes += rte_pktmbuf_pkt_len(pkts[j]);
+            }
+
+            stats->rx_pkts += nb_rx;
+            stats->rx_bytes += bytes;
+
+            dpdkc_capture_burst(pkts, nb_rx, CAPTURE_RX);
+
+            // Apply the software flow rules the NIC didn't take.
+            nb_keep = dpdkc_flow_sw_filter(rx_port, pkts, nb_rx);
+            stats->dropped += nb_rx - nb_keep;
+
+            if (nb_keep == 0)
+            {
+                continue;
+            }
+
+            if (pipeline_dist_mode == PIPELINE_DIST_FLOW)
+            {
+                dpdkc_pipeline_distribute_flows(pkts, nb_keep, stats);
+            }
+            else
+            {
+                dpdkc_pipeline_distribute(pkts, nb_keep, &next_worker, stats);
+            }
+        }
+
+        if (unlikely(ctx->is_main && stats_period > 0))
+        {
+            cur_tsc = rte_rdtsc();
+
+            if (cur_tsc - stats_tsc > stats_period_tsc)
+            {
+                dpdkc_stats_print();
+
+                stats_tsc = cur_tsc;
+            }
+        }
+
+        // Back off after too many consecutive empty loops.
+        if (loop_rx > 0)
+        {
+            idle_cnt = 0;
+        }
+        else if (idle_poll_threshold > 0 && ++idle_cnt >= idle_poll_threshold)
+        {
+            dpdkc_idle_backoff(&map->rx_queue_list[0], idle_cnt, 0);
+        }
+    }
+}
+
+/**
+ * The pipeline's worker stage. Runs the batch callback on bursts from the l-core's ring (split by RX port) and passes the packets it keeps to the l-core's TX ring.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param ctx A pointer to the l-core's context.
+ * 
+ * @return Void
+**/
+static void dpdkc_pipeline_worker(struct dpdkc_lcore_ctx *ctx)
+{
+    struct lcore_port_conf *qconf = ctx->conf;
+    struct dpdkc_lcore_stats *stats = ctx->stats;
+    struct rte_mbuf *pkts[MAX_PCKT_BURST];
+    __u16 burst = RTE_MIN(packet_burst_size, MAX_PCKT_BURST);
+    unsigned int nb_pkts, nb_keep, start, end, n, j;
+    __u16 rx_port;
+
+    while (!quit)
+    {
+        nb_pkts = rte_ring_dequeue_burst(qconf->in_ring, (void **)pkts, burst, NULL);
+
+        if (nb_pkts == 0)
+        {
+            stats->empty_polls++;
+
+            rte_pause();
+
+            continue;
+        }
+
+        for (j = 0; j < nb_pkts && j < CLASSIFY_PREFETCH_OFFSET; j++)
+        {
+            rte_prefetch0(rte_pktmbuf_mtod(pkts[j], void *));
+        }
+
+        nb_keep = 0;
+
+        dpdkc_arena_reset();
+
+        // The callback works on one RX port at a time, so call it for each run of packets from the same port.
+        for (start = 0; start < nb_pkts; start = end)
+        {
+            rx_port = pkts[start]->port;
+
+            for (end = start + 1; end < nb_pkts && pkts[end]->port == rx_port; end++);
+
+            n = (fwd_cb != NULL) ? fwd_cb(rx_port, &pkts[start], end - start) : end - start;
+
+            // Move the packets kept to the front (nb_keep never passes start).
+            for (j = 0; j < n; j++)
+            {
+                pkts[nb_keep++] = pkts[start + j];
+            }
+        }
+
+        stats->dropped += nb_pkts - nb_keep;
+
+        if (nb_keep == 0)
+        {
+            continue;
+        }
+
+        n = rte_ring_enqueue_burst(qconf->out_ring, (void * const *)pkts, nb_keep, NULL);
+
+        if (unlikely(n < nb_keep))
+        {
+            rte_pktmbuf_free_bulk(&pkts[n], nb_keep - n);
+
+            stats->dropped += nb_keep - n;
+        }
+    }
+}
+
+/**
+ * The pipeline's TX stage. Buffers packets from the l-core's ring to their destination port on the l-core's own TX queue.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param ctx A pointer to the l-core's context (the main l-core prints statistics).
+ * 
+ * @return Void
+**/
+static void dpdkc_pipeline_tx(struct dpdkc_lcore_ctx *ctx)
+{
+    struct lcore_port_conf *qconf = ctx->conf;
+    struct dpdkc_lcore_stats *stats = ctx->stats;
+    struct rte_mbuf *pkts[MAX_PCKT_BURST];
+    const struct dpdkc_fwd_conf *conf;
+    __u16 burst = RTE_MIN(packet_burst_size, MAX_PCKT_BURST);
+    __u16 tx_queue = ctx->tx_queue_id;
+    __u16 dst_port;
+    __u64 bytes, prev_tsc = 0, cur_tsc, stats_tsc = 0;
+    unsigned int nb_pkts, nb_sent, j;
+
+    const __u64 drain_tsc = (qconf->tx_drain_tsc != 0) ? qconf->tx_drain_tsc : (rte_get_tsc_hz() + US_PER_S - 1) / US_PER_S * BURST_TX_DRAIN_US;
+    const unsigned int drain_policy = (qconf->tx_drain_policy != TX_DRAIN_DEFAULT) ? qconf->tx_drain_policy : TX_DRAIN_DEADLINE;
+    const __u64 stats_period_tsc = rte_get_tsc_hz() * stats_period;
+
+    while (!quit)
+    {
+        cur_tsc = rte_rdtsc();
+
+        // Ports and the forwarding config may change between loops.
+        dpdkc_lcore_quiescent();
+
+        conf = dpdkc_fwd_conf_get();
+
+        // Drain the TX buffers once the deadline passes so packets don't sit in a partial burst.
+        if (unlikely(cur_tsc - prev_tsc > drain_tsc))
+        {
+            if (drain_policy & TX_DRAIN_DEADLINE)
+            {
+                dpdkc_lcore_tx_flush(qconf, stats);
+            }
+
+            prev_tsc = cur_tsc;
+
+            if (unlikely(ctx->is_main && stats_period > 0 && cur_tsc - stats_tsc > stats_period_tsc))
+            {
+                dpdkc_stats_print();
+
+                stats_tsc = cur_tsc;
+            }
+        }
+
+        nb_pkts = rte_ring_dequeue_burst(qconf->in_ring, (void **)pkts, burst, NULL);
+
+        if (nb_pkts == 0)
+        {
+            stats->empty_polls++;
+
+            // Send whatever is buffered once the ring runs dry.
+            if (drain_policy & TX_DRAIN_IDLE)
+            {
+                dpdkc_lcore_tx_flush(qconf, stats);
+            }
+
+            rte_pause();
+
+            continue;
+        }
+
+        dpdkc_capture_burst(pkts, nb_pkts, CAPTURE_TX);
+
+        bytes = 0;
+        nb_sent = 0;
+
+        for (j = 0; j < nb_pkts; j++)
+        {
+            dst_port = conf->tx_port[pkts[j]->port];
+
+            // Drop packets for a destination port that's down or removed.
+            if (unlikely(!dpdkc_port_is_up(dst_port)))
+            {
+                rte_pktmbuf_free(pkts[j]);
+
+                stats->tx_dropped++;
+
+                continue;
+            }
+
+            bytes += rte_pktmbuf_pkt_len(pkts[j]);
+            nb_sent++;
+
+            if (rte_eth_tx_buffer(dst_port, tx_queue, qconf->tx_buffer[dst_port], pkts[j]) > 0)
+            {
+                stats->tx_flushes++;
+            }
+        }
+
+        // Packets the NIC rejects are subtracted again by dpdkc_tx_err_count().
+        stats->tx_pkts += nb_sent;
+        stats->tx_bytes += bytes;
+    }
+
+    // Don't leave packets behind in partial buffers.
+    dpdkc_lcore_tx_flush(qconf, stats);
+}
+
+/**
+ * The pipeline loop ran on each l-core by dpdkc_run_pipeline(). Runs the l-core's stage.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param arg A pointer to the l-core's context.
+ * 
+ * @return 0 on exit.
+**/
+static int dpdkc_pipeline_lcore(void *arg)
+{
+    struct dpdkc_lcore_ctx *ctx = arg;
+    struct lcore_port_conf *qconf = ctx->conf;
+
+    // Only the RX and TX stages use ports.
+    if (qconf->role == LCORE_ROLE_RX || qconf->role == LCORE_ROLE_TX)
+    {
+        dpdkc_lcore_online();
+    }
+
+    switch (qconf->role)
+    {
+        case LCORE_ROLE_RX:
+            dpdkc_pipeline_rx(ctx);
+
+            break;
+
+        case LCORE_ROLE_WORKER:
+            dpdkc_pipeline_worker(ctx);
+
+            break;
+
+        case LCORE_ROLE_TX:
+            dpdkc_pipeline_tx(ctx);
+
+            break;
+
+        default:
+            if (ctx->is_main)
+            {
+                dpdkc_stats_loop();
+            }
+
+            break;
+    }
+
+    if (qconf->role == LCORE_ROLE_RX || qconf->role == LCORE_ROLE_TX)
+    {
+        dpdkc_lcore_offline();
+    }
+
+    return 0;
+}
+
+/**
+ * Launches the pipeline (RX, worker and TX stages connected by rings) on all l-cores and waits for them to exit.
+ * NOTE - Call after dpdkc_pipeline_mapping(), dpdkc_ports_queues_init() and dpdkc_pipeline_init().
+ * 
+ * @param cb The batch callback the workers call on each burst (NULL forwards everything). The callback must move packets it wants forwarded to the front of the array, free the rest and return how many are left.
+ * 
+ * @return Void
+**/
+void dpdkc_run_pipeline(dpdkc_batch_cb cb)
+{
+    fwd_cb = cb;
+
+    dpdkc_launch_and_run(dpdkc_pipeline_lcore);
+}
+
+/**
+ * Initializes a token bucket for a packet rate. The bucket holds at most two bursts.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param tb A pointer to the token bucket.
+ * @param pps The rate in packets per second (0 disables pacing).
+ * @param burst The burst size.
+ * 
+ * @return Void
+**/
+static void dpdkc_tb_init(struct dpdkc_token_bucket *tb, __u64 pps, __u16 burst)
+{
+    tb->cost = (pps > 0) ? (rte_get_tsc_hz() << 16) / pps : 0;
+    tb->depth = tb->cost * burst * 2;
+    tb->credit = 0;
+    tb->prev_tsc = rte_rdtsc();
+}
+
+/**
+ * Refills a token bucket from the TSC cycles elapsed and takes up to a burst of packets from it.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param tb A pointer to the token bucket.
+ * @param want The amount of packets wanted.
+ * 
+ * @return The amount of packets that may be sent now.
+**/
+static inline unsigned int dpdkc_tb_take(struct dpdkc_token_bucket *tb, unsigned int want)
+{
+    __u64 cur_tsc;
+    unsigned int nb;
+
+    if (tb->cost == 0)
+    {
+        return want;
+    }
+
+    cur_tsc = rte_rdtsc();
+    tb->credit = RTE_MIN(tb->credit + ((cur_tsc - tb->prev_tsc) << 16), tb->depth);
+    tb->prev_tsc = cur_tsc;
+
+    nb = RTE_MIN(want, tb->credit / tb->cost);
+    tb->credit -= nb * tb->cost;
+
+    return nb;
+}
+
+/**
+ * Writes the generator's template into a mbuf of the template pool (called once per mbuf when the pool is created).
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param mp A pointer to the mempool.
+ * @param opaque Unused.
+ * @param obj A pointer to the mbuf.
+ * @param obj_idx Unused.
+ * 
+ * @return Void
+**/
+static void dpdkc_gen_pool_init(struct rte_mempool *mp, void *opaque, void *obj, unsigned obj_idx)
+{
+    struct rte_mbuf *m = obj;
+
+    rte_pktmbuf_reset(m);
+
+    rte_memcpy(rte_pktmbuf_mtod(m, void *), gen_pkt, gen_conf.pkt_len);
+}
+
+/**
+ * Sets up the packet generator. The template is written into every mbuf of a dedicated pool once, so sending a packet only needs rte_pktmbuf_alloc_bulk() and the randomized fields written.
+ * NOTE - Call after dpdkc_ports_queues_init(). The generator transmits on each l-core's TX queue (tx_queue_id, e.g. from dpdkc_ports_queues_mapping_rss()).
+ * 
+ * @param conf A pointer to the generator's configuration (copied).
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The template pool is stored in ret.dataptr.
+**/
+struct dpdkc_ret dpdkc_gen_init(const struct dpdkc_gen_conf *conf)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    const struct rte_ether_hdr *eth;
+    const struct rte_ipv4_hdr *iph;
+    unsigned int nb_mbufs;
+    char name[RTE_MEMPOOL_NAMESIZE];
+
+    ret.port_id = conf->tx_port;
+
+    if (conf->pkt == NULL || conf->pkt_len < sizeof(struct rte_ether_hdr) || conf->pkt_len > sizeof(gen_pkt))
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Invalid generator template length.";
+
+        return ret;
+    }
+
+    if (conf->tx_port >= RTE_MAX_ETHPORTS || !ports[conf->tx_port].tx)
+    {
+        ret.err_num = -ENODEV;
+        ret.gen_msg = "Generator TX port isn't initialized for TX.";
+
+        return ret;
+    }
+
+    // Cloned mbufs have a reference count above 1, which fast free doesn't handle.
+    if (conf->clone && dpdkc_port_tx_offloaded(conf->tx_port, RTE_ETH_TX_OFFLOAD_MBUF_FAST_FREE))
+    {
+        ret.err_num = -ENOTSUP;
+        ret.gen_msg = "Generator clone mode can't be used with MBUF_FAST_FREE (request offloads without it).";
+
+        return ret;
+    }
+
+    dpdkc_gen_free();
+
+    gen_conf = *conf;
+    gen_conf.pkt = gen_pkt;
+
+    memcpy(gen_pkt, conf->pkt, conf->pkt_len);
+
+    gen_l3_off = 0;
+    gen_l4_off = 0;
+    gen_l4_proto = 0;
+    gen_tx_ol_flags = 0;
+
+    // Locate the IPv4 and L4 headers for field rewrites and checksums.
+    eth = (const struct rte_ether_hdr *)gen_pkt;
+
+    if (eth->ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) && conf->pkt_len >= sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv4_hdr))
+    {
+        iph = (const struct rte_ipv4_hdr *)(gen_pkt + sizeof(struct rte_ether_hdr));
+
+        gen_l3_off = sizeof(struct rte_ether_hdr);
+        gen_l4_off = gen_l3_off + (iph->version_ihl & RTE_IPV4_HDR_IHL_MASK) * RTE_IPV4_IHL_MULTIPLIER;
+        gen_l4_proto = iph->next_proto_id;
+
+        if ((gen_l4_proto == IPPROTO_TCP && gen_l4_off + sizeof(struct rte_tcp_hdr) > conf->pkt_len) || (gen_l4_proto == IPPROTO_UDP && gen_l4_off + sizeof(struct rte_udp_hdr) > conf->pkt_len))
+        {
+            gen_l4_proto = 0;
+        }
+    }
+
+    if (!conf->clone && (conf->rand_fields & (GEN_RAND_SRC_IP | GEN_RAND_DST_IP)) && gen_l3_off == 0)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Generator IP randomization requires an IPv4 template.";
+
+        return ret;
+    }
+
+    if (!conf->clone && (conf->rand_fields & (GEN_RAND_SRC_PORT | GEN_RAND_DST_PORT | GEN_INC_SEQ)) && gen_l4_proto != IPPROTO_TCP && gen_l4_proto != IPPROTO_UDP)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Generator port/sequence rewrites require a TCP or UDP template.";
+
+        return ret;
+    }
+
+    if ((conf->rand_fields & GEN_INC_SEQ) && gen_l4_proto != IPPROTO_TCP)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Generator sequence numbers require a TCP template.";
+
+        return ret;
+    }
+
+    // Leave checksums to the NIC when it can do them.
+    if (gen_l3_off != 0 && dpdkc_port_tx_offloaded(conf->tx_port, RTE_ETH_TX_OFFLOAD_IPV4_CKSUM))
+    {
+        gen_tx_ol_flags |= RTE_MBUF_F_TX_IPV4 | RTE_MBUF_F_TX_IP_CKSUM;
+    }
+
+    if (gen_l4_proto == IPPROTO_TCP && dpdkc_port_tx_offloaded(conf->tx_port, RTE_ETH_TX_OFFLOAD_TCP_CKSUM))
+    {
+        gen_tx_ol_flags |= RTE_MBUF_F_TX_IPV4 | RTE_MBUF_F_TX_TCP_CKSUM;
+    }
+    else if (gen_l4_proto == IPPROTO_UDP && dpdkc_port_tx_offloaded(conf->tx_port, RTE_ETH_TX_OFFLOAD_UDP_CKSUM))
+    {
+        gen_tx_ol_flags |= RTE_MBUF_F_TX_IPV4 | RTE_MBUF_F_TX_UDP_CKSUM;
+    }
+
+    // Enough mbufs to fill every l-core's TX ring plus its cache and a burst in flight.
+    nb_mbufs = rte_lcore_count() * (nb_txd + MEMPOOL_CACHE_SIZE + MAX_PCKT_BURST);
+
+    snprintf(name, sizeof(name), "gen_pool_%u", conf->tx_port);
+
+    if ((gen_pool = rte_pktmbuf_pool_create(name, nb_mbufs, MEMPOOL_CACHE_SIZE, 0, RTE_MBUF_DEFAULT_BUF_SIZE, dpdkc_port_socket(conf->tx_port))) == NULL)
+    {
+        ret.err_num = -rte_errno;
+        ret.gen_msg = "Failed to create generator template pool.";
+
+        return ret;
+    }
+
+    // Pre-build the template in every mbuf.
+    rte_mempool_obj_iter(gen_pool, dpdkc_gen_pool_init, NULL);
+
+    fprintf(stdout, "Generator => port #%u, %u byte template, %u mbufs, checksum offload flags 0x%llx, %s.\n", conf->tx_port, conf->pkt_len, nb_mbufs, (unsigned long long)gen_tx_ol_flags, conf->clone ? "cloning" : "template pool");
+
+    ret.dataptr = gen_pool;
+
+    return ret;
+}
+
+/**
+ * Frees the generator's template pool.
+ * 
+ * @return Void
+**/
+void dpdkc_gen_free()
+{
+    if (gen_pool != NULL)
+    {
+        rte_mempool_free(gen_pool);
+    }
+
+    gen_pool = NULL;
+}
+
+/**
+ * Picks a random value in [base, base + range) (wrapping) or any value if range is 0.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param base The base value (host byte order).
+ * @param range The amount of values.
+ * 
+ * @return The value (host byte order).
+**/
+static inline __u32 dpdkc_gen_rand(__u32 base, __u32 range)
+{
+    __u32 r = (__u32)rte_rand();
+
+    if (range == 0)
+    {
+        return r;
+    }
+
+    return base + (__u32)(((__u64)r * range) >> 32);
+}
+
+/**
+ * Rewrites a generated packet's fields and fills in its checksums (or the offload flags to have the NIC do it).
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param m A pointer to the mbuf (holding the template).
+ * @param seq A pointer to the l-core's TCP sequence number.
+ * 
+ * @return Void
+**/
+static inline void dpdkc_gen_fill(struct rte_mbuf *m, __u32 *seq)
+{
+    const struct rte_ipv4_hdr *tmpl_iph = (const struct rte_ipv4_hdr *)(gen_pkt + gen_l3_off);
+    const struct rte_udp_hdr *tmpl_l4h = (const struct rte_udp_hdr *)(gen_pkt + gen_l4_off);
+    __u8 *data = rte_pktmbuf_mtod(m, __u8 *);
+    struct rte_ipv4_hdr *iph;
+    struct rte_udp_hdr *udph;
+    struct rte_tcp_hdr *tcph;
+
+    m->data_len = gen_conf.pkt_len;
+    m->pkt_len = gen_conf.pkt_len;
+
+    if (gen_l3_off == 0)
+    {
+        return;
+    }
+
+    iph = (struct rte_ipv4_hdr *)(data + gen_l3_off);
+
+    if (gen_conf.rand_fields & GEN_RAND_SRC_IP)
+    {
+        iph->src_addr = rte_cpu_to_be_32(dpdkc_gen_rand(rte_be_to_cpu_32(tmpl_iph->src_addr), gen_conf.src_ip_range));
+    }
+
+    if (gen_conf.rand_fields & GEN_RAND_DST_IP)
+    {
+        iph->dst_addr = rte_cpu_to_be_32(dpdkc_gen_rand(rte_be_to_cpu_32(tmpl_iph->dst_addr), gen_conf.dst_ip_range));
+    }
+
+    // TCP and UDP both start with the source and destination ports.
+    if (gen_l4_proto == IPPROTO_TCP || gen_l4_proto == IPPROTO_UDP)
+    {
+        udph = (struct rte_udp_hdr *)(data + gen_l4_off);
+
+        if (gen_conf.rand_fields & GEN_RAND_SRC_PORT)
+        {
+            udph->src_port = rte_cpu_to_be_16(dpdkc_gen_rand(rte_be_to_cpu_16(tmpl_l4h->src_port), gen_conf.src_port_range));
+        }
+
+        if (gen_conf.rand_fields & GEN_RAND_DST_PORT)
+        {
+            udph->dst_port = rte_cpu_to_be_16(dpdkc_gen_rand(rte_be_to_cpu_16(tmpl_l4h->dst_port), gen_conf.dst_port_range));
+        }
+    }
+
+    if (gen_conf.rand_fields & GEN_INC_SEQ)
+    {
+        tcph = (struct rte_tcp_hdr *)(data + gen_l4_off);
+
+        tcph->sent_seq = rte_cpu_to_be_32((*seq)++);
+    }
+
+    // Nothing changed, so the template's checksums are still valid.
+    if (gen_conf.rand_fields == 0)
+    {
+        return;
+    }
+
+    m->ol_flags = gen_tx_ol_flags;
+    m->l2_len = gen_l3_off;
+    m->l3_len = gen_l4_off - gen_l3_off;
+
+    // IPv4 header checksum.
+    iph->hdr_checksum = 0;
+
+    if (!(gen_tx_ol_flags & RTE_MBUF_F_TX_IP_CKSUM))
+    {
+        iph->hdr_checksum = rte_ipv4_cksum(iph);
+    }
+
+    // L4 checksum (the NIC needs the pseudo header checksum to start from).
+    if (gen_l4_proto == IPPROTO_TCP)
+    {
+        tcph = (struct rte_tcp_hdr *)(data + gen_l4_off);
+        tcph->cksum = 0;
+
+        tcph->cksum = (gen_tx_ol_flags & RTE_MBUF_F_TX_TCP_CKSUM) ? rte_ipv4_phdr_cksum(iph, m->ol_flags) : rte_ipv4_udptcp_cksum(iph, tcph);
+    }
+    else if (gen_l4_proto == IPPROTO_UDP)
+    {
+        udph = (struct rte_udp_hdr *)(data + gen_l4_off);
+
+        // A zero UDP checksum is valid over IPv4, so skip it in software.
+        udph->dgram_cksum = (gen_tx_ol_flags & RTE_MBUF_F_TX_UDP_CKSUM) ? rte_ipv4_phdr_cksum(iph, m->ol_flags) : 0;
+    }
+}
+
+/**
+ * The generator loop ran on each l-core by dpdkc_run_generator(). Refills a token bucket in TSC cycles and sends up to a burst of packets per loop.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param arg A pointer to the l-core's context.
+ * 
+ * @return 0 on exit.
+**/
+static int dpdkc_gen_lcore(void *arg)
+{
+    struct dpdkc_lcore_ctx *ctx = arg;
+    struct rte_mbuf *pkts[MAX_PCKT_BURST];
+    struct rte_mbuf *tmpl = NULL;
+    struct dpdkc_lcore_stats *stats = ctx->stats;
+    __u16 burst = RTE_MIN(packet_burst_size, MAX_PCKT_BURST);
+    __u16 tx_port = gen_conf.tx_port;
+    struct dpdkc_token_bucket tb;
+    __u32 seq = (__u32)rte_rand();
+    unsigned int nb, sent, i;
+
+    // The main l-core reports statistics if other l-cores generate.
+    if (ctx->is_main && rte_lcore_count() > 1)
+    {
+        dpdkc_stats_loop();
+
+        return 0;
+    }
+
+    // Clone mode sends one pre-built mbuf over and over.
+    if (gen_conf.clone)
+    {
+        if ((tmpl = rte_pktmbuf_alloc(gen_pool)) == NULL)
+        {
+            fprintf(stdout, "WARNING - L-core %u failed to allocate a generator template.\n", ctx->lcore_id);
+
+            return 0;
+        }
+
+        tmpl->data_len = gen_conf.pkt_len;
+        tmpl->pkt_len = gen_conf.pkt_len;
+    }
+
+    dpdkc_tb_init(&tb, gen_conf.pps, burst);
+
+    while (!quit)
+    {
+        // Wait for the token bucket to refill.
+        if ((nb = dpdkc_tb_take(&tb, burst)) == 0)
+        {
+            rte_pause();
+
+            continue;
+        }
+
+        if (tmpl != NULL)
+        {
+            rte_mbuf_refcnt_update(tmpl, nb);
+
+            for (i = 0; i < nb; i++)
+            {
+                pkts[i] = tmpl;
+            }
+        }
+        else
+        {
+            if (rte_pktmbuf_alloc_bulk(gen_pool, pkts, nb) != 0)
+            {
+                stats->dropped += nb;
+
+                continue;
+            }
+
+            for (i = 0; i < nb; i++)
+            {
+                dpdkc_gen_fill(pkts[i], &seq);
+            }
+        }
+
+        sent = rte_eth_tx_burst(tx_port, ctx->tx_queue_id, pkts, nb);
+
+        stats->tx_pkts += sent;
+        stats->tx_bytes += (__u64)sent * gen_conf.pkt_len;
+
+        // Drop what the NIC didn't take rather than wait for it.
+        if (unlikely(sent < nb))
+        {
+            rte_pktmbuf_free_bulk(&pkts[sent], nb - sent);
+
+            stats->tx_dropped += nb - sent;
+        }
+    }
+
+    if (tmpl != NULL)
+    {
+        rte_pktmbuf_free(tmpl);
+    }
+
+    return 0;
+}
+
+/**
+ * Launches the packet generator (see dpdkc_gen_init()) on all l-cores and waits for them to exit. The main l-core only reports statistics when other l-cores are available.
+ * 
+ * @return Void
+**/
+void dpdkc_run_generator()
+{
+    dpdkc_launch_and_run(dpdkc_gen_lcore);
+}
+
+/**
+ * The capture writer thread. Drains every l-core's capture ring and writes the packets to the pcap file through a large stdio buffer.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param arg Unused.
+ * 
+ * @return NULL on exit.
+**/
+static void *dpdkc_capture_writer(void *arg)
+{
+    struct rte_mbuf *pkts[MAX_PCKT_BURST];
+    struct dpdkc_capture_meta *meta;
+    __u64 ns, hz = rte_get_tsc_hz();
+    __u32 rec[4];
+    unsigned int lcore, nb, total, i;
+    int stopping;
+
+    for (;;)
+    {
+        // Read the flag first so packets enqueued before stopping are still written.
+        stopping = capture_stop_writer;
+        total = 0;
+
+        RTE_LCORE_FOREACH(lcore)
+        {
+            if (capture_rings[lcore] == NULL)
+            {
+                continue;
+            }
+
+            nb = rte_ring_sc_dequeue_burst(capture_rings[lcore], (void **)pkts, MAX_PCKT_BURST, NULL);
+            total += nb;
+
+            for (i = 0; i < nb; i++)
+            {
+                meta = rte_mbuf_to_priv(pkts[i]);
+
+                // Convert the TSC timestamp to wall time relative to the capture's start.
+                ns = (__u64)capture_start_tv.tv_usec * 1000 + (meta->tsc - capture_start_tsc) / hz * NS_PER_S + (meta->tsc - capture_start_tsc) % hz * NS_PER_S / hz;
+
+                // Record header (seconds, nanoseconds, captured length, original length).
+                rec[0] = capture_start_tv.tv_sec + ns / NS_PER_S;
+                rec[1] = ns % NS_PER_S;
+                rec[2] = rte_pktmbuf_data_len(pkts[i]);
+                rec[3] = meta->orig_len;
+
+                fwrite(rec, sizeof(rec), 1, capture_file);
+                fwrite(rte_pktmbuf_mtod(pkts[i], void *), rec[2], 1, capture_file);
+
+                capture_written++;
+            }
+
+            rte_pktmbuf_free_bulk(pkts, nb);
+        }
+
+        if (total == 0)
+        {
+            if (stopping)
+            {
+                break;
+            }
+
+            rte_delay_us_sleep(1000);
+        }
+    }
+
+    fflush(capture_file);
+
+    return NULL;
+}
+
+/**
+ * Starts capturing (copies of) a sampled or filtered subset of the packets passed to dpdkc_capture_burst() into a pcap file (nanosecond resolution). Copies come from a dedicated pool and are handed to a writer thread through one ring per l-core. The fast path never blocks: packets are dropped and counted in cap_dropped when the pool or ring is full.
+ * NOTE - The built-in forwarder and pipeline call dpdkc_capture_burst() on their RX and TX bursts.
+ * 
+ * @param path The pcap file's path.
+ * @param dirs The directions to capture (CAPTURE_RX and/or CAPTURE_TX).
+ * @param sample Capture one in every sample packets per l-core (0 or 1 captures every packet).
+ * @param snaplen The maximum amount of bytes captured per packet (0 or above RTE_MBUF_DEFAULT_DATAROOM uses RTE_MBUF_DEFAULT_DATAROOM).
+ * @param filter A filter called on each sampled packet (NULL captures every sampled packet).
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_capture_start(const char *path, unsigned int dirs, unsigned int sample, __u32 snaplen, dpdkc_capture_filter filter)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    char name[RTE_RING_NAMESIZE];
+    unsigned int lcore;
+
+    // The pcap file header (nanosecond magic, version 2.4, Ethernet link type).
+    __u32 hdr[6] = {0xA1B23C4D, 2 | (4 << 16), 0, 0, 0, 1};
+
+    if (capture_file != NULL)
+    {
+        ret.err_num = -EBUSY;
+        ret.gen_msg = "A capture is already running.";
+
+        return ret;
+    }
+
+    if ((dirs & (CAPTURE_RX | CAPTURE_TX)) == 0)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "No capture direction given.";
+
+        return ret;
+    }
+
+    capture_sample = (sample > 1) ? sample : 1;
+    capture_snaplen = (snaplen > 0 && snaplen < RTE_MBUF_DEFAULT_DATAROOM) ? snaplen : RTE_MBUF_DEFAULT_DATAROOM;
+    capture_filter = filter;
+    capture_written = 0;
+
+    hdr[4] = capture_snaplen;
+
+    // Copies carry their timestamp and original length in the mbuf's private area.
+    if ((capture_pool = rte_pktmbuf_pool_create("capture_pool", rte_lcore_count() * CAPTURE_RING_SIZE, MEMPOOL_CACHE_SIZE, RTE_ALIGN_CEIL(sizeof(struct dpdkc_capture_meta), RTE_MBUF_PRIV_ALIGN), RTE_PKTMBUF_HEADROOM + capture_snaplen, rte_socket_id())) == NULL)
+    {
+        ret.err_num = -rte_errno;
+        ret.gen_msg = "Failed to create capture pool.";
+
+        return ret;
+    }
+
+    RTE_LCORE_FOREACH(lcore)
+    {
+        snprintf(name, sizeof(name), "capture_%u", lcore);
+
+        if ((capture_rings[lcore] = rte_ring_create(name, CAPTURE_RING_SIZE, rte_lcore_to_socket_id(lcore), RING_F_SP_ENQ | RING_F_SC_DEQ)) == NULL)
+        {
+            ret.err_num = -rte_errno;
+            ret.data = lcore;
+            ret.gen_msg = "Failed to create capture ring.";
+
+            dpdkc_capture_stop();
+
+            return ret;
+        }
+    }
+
+    // Write through a large buffer so the writer issues few, big writes.
+    if ((capture_file = fopen(path, "wb")) == NULL)
+    {
+        ret.err_num = -errno;
+        ret.gen_msg = "Failed to open capture file.";
+
+        dpdkc_capture_stop();
+
+        return ret;
+    }
+
+    if ((capture_buf = malloc(CAPTURE_WRITE_BUF_SIZE)) != NULL)
+    {
+        setvbuf(capture_file, capture_buf, _IOFBF, CAPTURE_WRITE_BUF_SIZE);
+    }
+
+    fwrite(hdr, sizeof(hdr), 1, capture_file);
+
+    gettimeofday(&capture_start_tv, NULL);
+    capture_start_tsc = rte_rdtsc();
+
+    capture_stop_writer = 0;
+
+    if ((ret.err_num = -pthread_create(&capture_thread, NULL, dpdkc_capture_writer, NULL)) != 0)
+    {
+        ret.gen_msg = "Failed to create capture writer thread.";
+
+        fclose(capture_file);
+        capture_file = NULL;
+
+        dpdkc_capture_stop();
+
+        return ret;
+    }
+
+    // Enable capturing on the fast path last.
+    rte_smp_wmb();
+
+    capture_dirs = dirs;
+
+    fprintf(stdout, "Capturing to %s (1 in %u packets, %u byte snap length).\n", path, capture_sample, capture_snaplen);
+
+    return ret;
+}
+
+/**
+ * Copies the sampled and filtered packets of a burst into the l-core's capture ring (if a capture is running in this direction).
+ * 
+ * @param pkts A pointer to the burst's mbufs (left untouched).
+ * @param nb_pkts The amount of packets.
+ * @param dir The burst's direction (CAPTURE_RX or CAPTURE_TX).
+ * 
+ * @return Void
+**/
+void dpdkc_capture_burst(struct rte_mbuf **pkts, __u16 nb_pkts, unsigned int dir)
+{
+    struct rte_mbuf *copies[MAX_PCKT_BURST];
+    struct dpdkc_capture_meta *meta;
+    struct dpdkc_lcore_stats *stats;
+    struct rte_ring *ring;
+    __u64 now;
+    unsigned int nb = 0, n, i;
+
+    if (likely((capture_dirs & dir) == 0))
+    {
+        return;
+    }
+
+    ring = capture_rings[rte_lcore_id()];
+    stats = &lcore_stats[rte_lcore_id()];
+
+    if (ring == NULL)
+    {
+        return;
+    }
+
+    now = rte_rdtsc();
+
+    for (i = 0; i < nb_pkts && i < MAX_PCKT_BURST; i++)
+    {
+        if (capture_sample > 1 && (stats->cap_seen++ % capture_sample) != 0)
+        {
+            continue;
+        }
+
+        if (capture_filter != NULL && !capture_filter(pkts[i]))
+        {
+            continue;
+        }
+
+        // Copy up to the snap length from the capture pool (fails when the writer falls behind).
+        if ((copies[nb] = rte_pktmbuf_copy(pkts[i], capture_pool, 0, capture_snaplen)) == NULL)
+        {
+            stats->cap_dropped++;
+
+            continue;
+        }
+
+        meta = rte_mbuf_to_priv(copies[nb]);
+        meta->tsc = now;
+        meta->orig_len = rte_pktmbuf_pkt_len(pkts[i]);
+
+        nb++;
+    }
+
+    if (nb == 0)
+    {
+        return;
+    }
+
+    n = rte_ring_sp_enqueue_burst(ring, (void * const *)copies, nb, NULL);
+
+    stats->cap_pkts += n;
+
+    if (unlikely(n < nb))
+    {
+        rte_pktmbuf_free_bulk(&copies[n], nb - n);
+
+        stats->cap_dropped += nb - n;
+    }
+}
+
+/**
+ * Stops the running capture, writes out the packets still queued and closes the pcap file.
+ * NOTE - Stop the capture once the l-cores have exited (or after they stopped calling dpdkc_capture_burst()).
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The amount of packets written is stored in ret.data.
+**/
+struct dpdkc_ret dpdkc_capture_stop()
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    __u64 dropped = 0;
+    unsigned int lcore;
+
+    // Disable capturing on the fast path and give in-flight bursts a moment to finish.
+    capture_dirs = 0;
+
+    rte_delay_us_sleep(1000);
+
+    // Let the writer drain the rings and exit.
+    if (capture_file != NULL)
+    {
+        capture_stop_writer = 1;
+
+        pthread_join(capture_thread, NULL);
+
+        fclose(capture_file);
+        capture_file = NULL;
+    }
+
+    free(capture_buf);
+    capture_buf = NULL;
+
+    RTE_LCORE_FOREACH(lcore)
+    {
+        if (capture_rings[lcore] != NULL)
+        {
+            rte_ring_free(capture_rings[lcore]);
+        }
+
+        capture_rings[lcore] = NULL;
+
+        dropped += lcore_stats[lcore].cap_dropped;
+    }
+
+    if (capture_pool != NULL)
+    {
+        rte_mempool_free(capture_pool);
+
+        fprintf(stdout, "Capture stopped => %llu packets written, %llu dropped.\n", (unsigned long long)capture_written, (unsigned long long)dropped);
+    }
+
+    capture_pool = NULL;
+
+    ret.data = capture_written;
+
+    return ret;
+}
+
+/**
+ * Memory-maps a pcap file (Ethernet, microsecond or nanosecond, either byte order) and preloads its packets into mbufs from pcktmbuf_pool for dpdkc_run_replay().
+ * NOTE - Create the pool first (dpdkc_create_mbuf(), raising mbuf_extra if there are no ports). Packets longer than the pool's data room are truncated and loading stops early if the pool runs out.
+ * 
+ * @param path The pcap file's path.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The amount of packets loaded is stored in ret.data.
+**/
+struct dpdkc_ret dpdkc_replay_load(const char *path)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    struct rte_mbuf *m;
+    struct stat st;
+    const __u8 *map, *p, *end;
+    const __u32 *hdr;
+    __u32 caplen, nb = 0, max_pkts;
+    __u16 room;
+    int fd, swapped;
+
+    if (pcktmbuf_pool == NULL)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Create the mbuf pool before loading a replay.";
+
+        return ret;
+    }
+
+    dpdkc_replay_free();
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+    {
+        ret.err_num = -errno;
+        ret.gen_msg = "Failed to open replay file.";
+
+        return ret;
+    }
+
+    if (fstat(fd, &st) != 0 || st.st_size < 24)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Replay file is too small to be a pcap file.";
+
+        close(fd);
+
+        return ret;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        ret.err_num = -errno;
+        ret.gen_msg = "Failed to memory-map replay file.";
+
+        return ret;
+    }
+
+    // Read the records sequentially.
+    madvise((void *)map, st.st_size, MADV_SEQUENTIAL);
+
+    hdr = (const __u32 *)map;
+    end = map + st.st_size;
+
+    // Accept microsecond and nanosecond pcap files written in either byte order.
+    swapped = (hdr[0] == 0xD4C3B2A1 || hdr[0] == 0x4D3CB2A1);
+
+    if (!swapped && hdr[0] != 0xA1B2C3D4 && hdr[0] != 0xA1B23C4D)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Replay file isn't a pcap file (pcapng isn't supported).";
+
+        munmap((void *)map, st.st_size);
+
+        return ret;
+    }
+
+    if ((swapped ? rte_bswap32(hdr[5]) : hdr[5]) != 1)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Replay file's link type isn't Ethernet.";
+
+        munmap((void *)map, st.st_size);
+
+        return ret;
+    }
+
+    // Every record is at least its 16 byte header.
+    max_pkts = (st.st_size - 24) / 16;
+
+    replay_pkts = rte_zmalloc("replay_pkts", sizeof(*replay_pkts) * (max_pkts + 1), RTE_CACHE_LINE_SIZE);
+    replay_lens = rte_zmalloc("replay_lens", sizeof(*replay_lens) * (max_pkts + 1), RTE_CACHE_LINE_SIZE);
+
+    if (replay_pkts == NULL || replay_lens == NULL)
+    {
+        ret.err_num = -ENOMEM;
+        ret.gen_msg = "Failed to allocate replay packet array.";
+
+        munmap((void *)map, st.st_size);
+        dpdkc_replay_free();
+
+        return ret;
+    }
+
+    room = rte_pktmbuf_data_room_size(pcktmbuf_pool) - RTE_PKTMBUF_HEADROOM;
+
+    for (p = map + 24; p + 16 <= end; p += 16 + caplen)
+    {
+        hdr = (const __u32 *)p;
+        caplen = swapped ? rte_bswap32(hdr[2]) : hdr[2];
+
+        if (p + 16 + caplen > end)
+        {
+            fprintf(stdout, "WARNING - Replay file is truncated after %u packets.\n", nb);
+
+            break;
+        }
+
+        if ((m = rte_pktmbuf_alloc(pcktmbuf_pool)) == NULL)
+        {
+            fprintf(stdout, "WARNING - Ran out of mbufs after preloading %u replay packets.\n", nb);
+
+            break;
+        }
+
+        replay_lens[nb] = RTE_MIN(caplen, room);
+
+        rte_memcpy(rte_pktmbuf_mtod(m, void *), p + 16, replay_lens[nb]);
+
+        replay_pkts[nb++] = m;
+    }
+
+    munmap((void *)map, st.st_size);
+
+    nb_replay_pkts = nb;
+
+    fprintf(stdout, "Preloaded %u packets from %s.\n", nb, path);
+
+    ret.data = nb;
+
+    return ret;
+}
+
+/**
+ * The replay loop ran on each l-core by dpdkc_run_replay(). Each l-core replays its own contiguous share of the preloaded packets.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param arg A pointer to the l-core's context.
+ * 
+ * @return 0 on exit.
+**/
+static int dpdkc_replay_lcore(void *arg)
+{
+    struct dpdkc_lcore_ctx *ctx = arg;
+    struct rte_mbuf *pkts[MAX_PCKT_BURST];
+    struct dpdkc_lcore_stats *stats = ctx->stats;
+    struct dpdkc_token_bucket tb;
+    __u16 burst = RTE_MIN(packet_burst_size, MAX_PCKT_BURST);
+    __u32 idx = rte_lcore_index(ctx->lcore_id), nb_lcores_run = rte_lcore_count();
+    __u32 first = (__u64)nb_replay_pkts * idx / nb_lcores_run;
+    __u32 last = (__u64)nb_replay_pkts * (idx + 1) / nb_lcores_run;
+    __u32 pos;
+    __u64 bytes;
+    unsigned int loop, nb, nb_keep, i;
+
+    dpdkc_tb_init(&tb, replay_pps, burst);
+
+    for (loop = 0; !quit && (replay_loops == 0 || loop < replay_loops); loop++)
+    {
+        for (pos = first; pos < last && !quit; pos += nb)
+        {
+            // Wait for the token bucket to refill.
+            if ((nb = dpdkc_tb_take(&tb, RTE_MIN(burst, last - pos))) == 0)
+            {
+                rte_pause();
+
+                continue;
+            }
+
+            // The callback compacts the array it's given, so hand it a copy.
+            rte_memcpy(pkts, &replay_pkts[pos], sizeof(*pkts) * nb);
+
+            bytes = 0;
+
+            // Reset each packet as if it was just received and hold an extra reference so the callback's frees don't return it to the pool.
+            for (i = 0; i < nb; i++)
+            {
+                pkts[i]->data_off = RTE_PKTMBUF_HEADROOM;
+                pkts[i]->data_len = replay_lens[pos + i];
+                pkts[i]->pkt_len = replay_lens[pos + i];
+                pkts[i]->port = replay_port;
+                pkts[i]->ol_flags = 0;
+
+                rte_mbuf_refcnt_update(pkts[i], 1);
+
+                bytes += replay_lens[pos + i];
+            }
+
+            stats->rx_pkts += nb;
+            stats->rx_bytes += bytes;
+
+            dpdkc_arena_reset();
+
+            nb_keep = (fwd_cb != NULL) ? fwd_cb(replay_port, pkts, nb) : nb;
+
+            stats->dropped += nb - nb_keep;
+            stats->tx_pkts += nb_keep;
+
+            // There's nowhere to send the packets, so drop the callback's reference.
+            rte_pktmbuf_free_bulk(pkts, nb_keep);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Feeds the packets preloaded by dpdkc_replay_load() to a batch callback on all l-cores (each l-core takes a contiguous share) and waits until every l-core has replayed its share loops times.
+ * NOTE - The callback may drop (free) or keep packets but must not modify them since they're replayed again. Kept packets are counted as transmitted.
+ * 
+ * @param cb The batch callback (NULL keeps every packet).
+ * @param rx_port The port ID the callback and mbufs see as the RX port.
+ * @param pps The rate per l-core in packets per second (0 replays as fast as possible).
+ * @param loops The amount of times to replay the packets (0 loops until quit is set).
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The amount of packets replayed is stored in ret.data.
+**/
+struct dpdkc_ret dpdkc_run_replay(dpdkc_batch_cb cb, __u16 rx_port, __u64 pps, unsigned int loops)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    __u64 start_tsc, cycles, total = 0;
+    unsigned int lcore;
+    double secs;
+
+    if (nb_replay_pkts == 0)
+    {
+        ret.err_num = -ENOENT;
+        ret.gen_msg = "No replay packets loaded.";
+
+        return ret;
+    }
+
+    fwd_cb = cb;
+    replay_port = rx_port;
+    replay_pps = pps;
+    replay_loops = loops;
+
+    RTE_LCORE_FOREACH(lcore)
+    {
+        total -= lcore_stats[lcore].rx_pkts;
+    }
+
+    start_tsc = rte_rdtsc();
+
+    dpdkc_launch_and_run(dpdkc_replay_lcore);
+
+    cycles = rte_rdtsc() - start_tsc;
+
+    RTE_LCORE_FOREACH(lcore)
+    {
+        total += lcore_stats[lcore].rx_pkts;
+    }
+
+    secs = (double)cycles / rte_get_tsc_hz();
+
+    fprintf(stdout, "Replayed %llu packets in %.3f seconds (%.3f Mpps, %.1f cycles/packet per l-core).\n", (unsigned long long)total, secs, (secs > 0) ? total / secs / 1e6 : 0, (total > 0) ? (double)cycles * rte_lcore_count() / total : 0);
+
+    ret.data = total;
+
+    return ret;
+}
+
+/**
+ * Frees the packets preloaded by dpdkc_replay_load().
+ * 
+ * @return Void
+**/
+void dpdkc_replay_free()
+{
+    if (replay_pkts != NULL)
+    {
+        rte_pktmbuf_free_bulk(replay_pkts, nb_replay_pkts);
+    }
+
+    rte_free(replay_pkts);
+    rte_free(replay_lens);
+
+    replay_pkts = NULL;
+    replay_lens = NULL;
+    nb_replay_pkts = 0;
+}
+
+/**
+ * Allocates an arena of arena_size bytes for every enabled l-core from hugepage memory on the l-core's NUMA socket. The memory is zeroed (touched) here so the fast path never faults.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_arenas_init()
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    unsigned int lcore;
+
+    if (!rte_eal_has_hugepages())
+    {
+        fprintf(stdout, "WARNING - EAL runs without hugepages. Arenas will be backed by 4K pages.\n");
+    }
+
+    RTE_LCORE_FOREACH(lcore)
+    {
+        struct dpdkc_arena *arena = &lcore_arena[lcore];
+
+        if (arena->base != NULL)
+        {
+            continue;
+        }
+
+        memset(arena, 0, sizeof(*arena));
+
+        arena->base = rte_zmalloc_socket("lcore_arena", arena_size, RTE_CACHE_LINE_SIZE, rte_lcore_to_socket_id(lcore));
+
+        if (arena->base == NULL)
+        {
+            ret.err_num = -ENOMEM;
+            ret.gen_msg = "Failed to allocate l-core arena.";
+
+            dpdkc_arenas_free();
+
+            return ret;
+        }
+
+        arena->size = arena_size;
+    }
+
+    return ret;
+}
+
+/**
+ * Carves a fixed-size object pool from the bottom of an l-core's arena. The pool survives dpdkc_arena_reset() and is used with dpdkc_objpool_get()/dpdkc_objpool_put().
+ * NOTE - Call after dpdkc_arenas_init() and before the l-cores are launched. Create pools in the same order on every l-core so their IDs match.
+ * 
+ * @param lcore The l-core ID (-1 = all enabled l-cores).
+ * @param obj_size The size of each object in bytes (rounded up to a multiple of the pointer size).
+ * @param nb_objs The amount of objects.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The pool ID is stored in ret.data.
+**/
+struct dpdkc_ret dpdkc_objpool_create(int lcore, __u32 obj_size, __u32 nb_objs)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    struct dpdkc_arena *arena;
+    struct dpdkc_objpool *pool;
+    unsigned int id;
+    __u32 i;
+    __u8 *obj;
+
+    if (lcore < 0)
+    {
+        RTE_LCORE_FOREACH(id)
+        {
+            ret = dpdkc_objpool_create(id, obj_size, nb_objs);
+
+            if (ret.err_num != 0)
+            {
+                break;
+            }
+        }
+
+        return ret;
+    }
+
+    arena = &lcore_arena[lcore];
+
+    if (arena->base == NULL)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "L-core arena isn't allocated (see dpdkc_arenas_init()).";
+
+        return ret;
+    }
+
+    if (arena->nb_pools >= ARENA_MAX_POOLS)
+    {
+        ret.err_num = -ENOSPC;
+        ret.gen_msg = "Too many object pools on l-core (see ARENA_MAX_POOLS).";
+
+        return ret;
+    }
+
+    obj_size = RTE_ALIGN_CEIL(RTE_MAX(obj_size, (__u32)sizeof(void *)), sizeof(void *));
+
+    // Pools are only carved before anything is allocated from the arena, so start at the floor.
+    if (nb_objs == 0 || (__u64)obj_size * nb_objs > arena->size - arena->floor)
+    {
+        ret.err_num = -ENOMEM;
+        ret.gen_msg = "Object pool doesn't fit in the l-core's arena (see arena_size).";
+
+        return ret;
+    }
+
+    id = arena->nb_pools++;
+    pool = &arena->pools[id];
+
+    pool->obj_size = obj_size;
+    pool->nb_objs = nb_objs;
+    pool->nb_free = nb_objs;
+    pool->min_free = nb_objs;
+    pool->failed = 0;
+
+    // Chain the objects in address order so early allocations are close together.
+    obj = arena->base + arena->floor;
+    pool->free_list = obj;
+
+    for (i = 0; i < nb_objs; i++, obj += obj_size)
+    {
+        *(void **)obj = (i + 1 < nb_objs) ? obj + obj_size : NULL;
+    }
+
+    arena->floor = RTE_ALIGN_CEIL(arena->floor + (size_t)obj_size * nb_objs, RTE_CACHE_LINE_SIZE);
+    arena->floor = RTE_MIN(arena->floor, arena->size);
+    arena->off = arena->floor;
+    arena->high_water = RTE_MAX(arena->high_water, arena->floor);
+
+    ret.data = id;
+
+    return ret;
+}
+
+/**
+ * Frees every l-core's arena along with its object pools.
+ * 
+ * @return Void
+**/
+void dpdkc_arenas_free()
+{
+    unsigned int lcore;
+
+    for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++)
+    {
+        rte_free(lcore_arena[lcore].base);
+
+        memset(&lcore_arena[lcore], 0, sizeof(lcore_arena[lcore]));
+    }
+}
+
+/**
+ * Prints each l-core's arena usage and object pool usage.
+ * 
+ * @return Void
+**/
+void dpdkc_arena_stats_print()
+{
+    unsigned int lcore, i;
+
+    for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++)
+    {
+        struct dpdkc_arena *arena = &lcore_arena[lcore];
+
+        if (arena->base == NULL)
+        {
+            continue;
+        }
+
+        fprintf(stdout, "L-core %u arena: %zu/%zu bytes (high water %zu, pools %zu). Allocs => %llu. Failed => %llu. Resets => %llu.\n", lcore, arena->off, arena->size, arena->high_water, arena->floor, (unsigned long long)arena->allocs, (unsigned long long)arena->failed, (unsigned long long)arena->resets);
+
+        for (i = 0; i < arena->nb_pools; i++)
+        {
+            struct dpdkc_objpool *pool = &arena->pools[i];
+
+            fprintf(stdout, "    Pool %u: %u/%u objects of %u bytes in use (peak %u). Failed => %llu.\n", i, pool->nb_objs - pool->nb_free, pool->nb_objs, pool->obj_size, pool->nb_objs - pool->min_free, (unsigned long long)pool->failed);
+        }
+    }
+}
+
+/**
+ * Stops and removes all running ports.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_port_stop_and_remove()
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    __u16 pid;
+    int cancelled;
+
+    // Stop listening for link changes and removals before the ports go away.
+    if (lsc_cb_registered)
+    {
+        rte_eth_dev_callback_unregister(RTE_ETH_ALL, RTE_ETH_EVENT_INTR_LSC, dpdkc_lsc_event, NULL);
+
+        lsc_cb_registered = 0;
+    }
+
+    if (rmv_cb_registered)
+    {
+        rte_eth_dev_callback_unregister(RTE_ETH_ALL, RTE_ETH_EVENT_INTR_RMV, dpdkc_rmv_event, NULL);
+        // Alarms that never ran won't tear their port down.
+        if ((cancelled = rte_eal_alarm_cancel(dpdkc_port_rmv_alarm, (void *)-1)) > 0)
+        {
+            __atomic_sub_fetch(&rmv_pending, cancelled, __ATOMIC_RELAXED);
+        }
+
+        // Let removed ports that are already being torn down finish.
+        while (__atomic_load_n(&rmv_pending, __ATOMIC_ACQUIRE) > 0)
+        {
+            rte_delay_ms(LINK_POLL_MS);
+        }
+
+        rmv_cb_registered = 0;
+    }
+
+    RTE_ETH_FOREACH_DEV(pid)
+    {
+        // Skip disabled ports.
+        if (!dpdkc_port_enabled(pid))
+        {
+            continue;
+        }
+
+        fprintf(stdout, "Closing port #%u.\n", pid);
+
+        // Remove the port's flow rules.
+        dpdkc_flow_rules_flush(pid);
+
+        // Stop the port and check.
+        if ((ret.err_num = rte_eth_dev_stop(pid)) != 0)
+        {
+            return ret;
+        }
+
+        // Finally, close the port.
+        rte_eth_dev_close(pid);
+    }
+
+    return ret;
+}
+
+/**
+ * Cleans up the DPDK application's EAL. Frees the l-cores' port and queue lists and the published forwarding config first.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_eal_cleanup()
+{
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    struct lcore_port_conf *qconf;
+    unsigned int lcore;
+
+    for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++)
+    {
+        qconf = &lcore_port_conf[lcore];
+
+        rte_free(qconf->rx_port_list);
+        rte_free(qconf->tx_port_list);
+        rte_free(qconf->rx_queue_list);
+
+        qconf->rx_port_list = NULL;
+        qconf->tx_port_list = NULL;
+        qconf->rx_queue_list = NULL;
+        qconf->num_rx_ports = qconf->max_rx_ports = 0;
+        qconf->num_tx_ports = qconf->max_tx_ports = 0;
+        qconf->num_rx_queues = qconf->max_rx_queues = 0;
+    }
+
+    dpdkc_fwd_conf_free(__atomic_exchange_n(&fwd_conf, NULL, __ATOMIC_ACQ_REL));
+
+    ret.err_num = rte_eal_cleanup();
+
+    return ret;
+}
+
+/**
+ * Checks error from dpdkc_ret structure and prints error along with exits if found.
+ * 
+ * @return Void
+**/
+void dpdkc_check_ret(struct dpdkc_ret *ret)
+{
+    if (ret->err_num != 0)
+    {
+        char msg[256];
+        snprintf(msg, sizeof(msg) - 1, "%s Port ID => %d. RX queue ID => %d. TX queue ID => %d. Error => %s (%d).\n", (ret->gen_msg != NULL) ? ret->gen_msg : "N/A", ret->port_id, ret->rx_id, ret->tx_id, strerror(-ret->err_num), ret->err_num);
+
+        rte_exit(EXIT_FAILURE, "%s", msg);
+    }
+}
+
+/**
+ * Prints the aggregated l-core statistics along with each enabled port's NIC statistics and the rates since the last call.
+ * NOTE - Meant to be called from a single l-core (e.g. the main l-core).
+ * 
+ * @return Void
+**/
+void dpdkc_stats_print()
+{
+    // Totals and time of the previous report for rate calculations.
+    static struct dpdkc_lcore_stats prev;
+    static __u64 prev_tsc = 0;
+
+    struct dpdkc_lcore_stats total = {0};
+    struct dpdkc_lcore_stats *ls;
+    struct rte_eth_stats eth_stats;
+    __u64 cur_tsc = rte_rdtsc();
+    double secs;
+    unsigned int lcore;
+    __u16 pid;
+
+    fprintf(stdout, "\n==== Statistics ====\n");
+
+    RTE_LCORE_FOREACH(lcore)
+    {
+        ls = &lcore_stats[lcore];
+
+        // Skip l-cores that don't poll and haven't seen traffic (generator and replay l-cores don't poll).
+        if (lcore_port_conf[lcore].num_rx_queues == 0 && lcore_port_conf[lcore].role == LCORE_ROLE_NONE && ls->rx_pkts == 0 && ls->tx_pkts == 0)
+        {
+            continue;
+        }
+
+        fprintf(stdout, "L-core %u => RX %llu pkts (%llu bytes), TX %llu pkts (%llu bytes), dropped %llu, TX dropped %llu, empty polls %llu, TX flushes %llu, idle sleeps %llu.\n", lcore, (unsigned long long)ls->rx_pkts, (unsigned long long)ls->rx_bytes, (unsigned long long)ls->tx_pkts, (unsigned long long)ls->tx_bytes, (unsigned long long)ls->dropped, (unsigned long long)ls->tx_dropped, (unsigned long long)ls->empty_polls, (unsigned long long)ls->tx_flushes, (unsigned long long)ls->idle_sleeps);
+
+        total.rx_pkts += ls->rx_pkts;
+        total.rx_bytes += ls->rx_bytes;
+        total.tx_pkts += ls->tx_pkts;
+        total.tx_bytes += ls->tx_bytes;
+        total.dropped += ls->dropped;
+        total.tx_dropped += ls->tx_dropped;
+        total.empty_polls += ls->empty_polls;
+        total.tx_flushes += ls->tx_flushes;
+        total.idle_sleeps += ls->idle_sleeps;
+    }
+
+    // NIC statistics tell us about drops before packets ever reach an l-core.
+    RTE_ETH_FOREACH_DEV(pid)
+    {
+        if (!dpdkc_port_mask_test(enabled_port_mask, pid))
+        {
+            continue;
+        }
+
+        if (rte_eth_stats_get(pid, &eth_stats) != 0)
+        {
+            continue;
+        }
+
+        fprintf(stdout, "Port %u => RX %llu pkts, TX %llu pkts, missed (RX ring full) %llu, no mbuf %llu, RX errors %llu, TX errors %llu.\n", pid, (unsigned long long)eth_stats.ipackets, (unsigned long long)eth_stats.opackets, (unsigned long long)eth_stats.imissed, (unsigned long long)eth_stats.rx_nombuf, (unsigned long long)eth_stats.ierrors, (unsigned long long)eth_stats.oerrors);
+    }
+
+    // Calculate rates since the last report.
+    if (prev_tsc != 0 && cur_tsc > prev_tsc)
+    {
+        secs = (double)(cur_tsc - prev_tsc) / rte_get_tsc_hz();
+
+        fprintf(stdout, "Rates => RX %.0f pps (%.2f Mbps), TX %.0f pps (%.2f Mbps).\n", (total.rx_pkts - prev.rx_pkts) / secs, (total.rx_bytes - prev.rx_bytes) * 8 / secs / 1000000, (total.tx_pkts - prev.tx_pkts) / secs, (total.tx_bytes - prev.tx_bytes) * 8 / secs / 1000000);
+    }
+
+    fprintf(stdout, "Total => RX %llu pkts, TX %llu pkts, dropped %llu, TX dropped %llu.\n", (unsigned long long)total.rx_pkts, (unsigned long long)total.tx_pkts, (unsigned long long)total.dropped, (unsigned long long)total.tx_dropped);
+    fflush(stdout);
+
+    prev = total;
+    prev_tsc = cur_tsc;
+}
+
+/**
+ * Prints all non-zero extended statistics of a port.
+ * 
+ * @param pid The port ID.
+ * 
+ * @return Void
+**/
+void dpdkc_stats_print_xstats(__u16 pid)
+{
+    struct rte_eth_xstat *xstats;
+    struct rte_eth_xstat_name *names;
+    int len, i;
+
+    // Retrieve the amount of extended statistics first.
+    if ((len = rte_eth_xstats_get(pid, NULL, 0)) <= 0)
+    {
+        return;
+    }
+
+    xstats = calloc(len, sizeof(*xstats));
+    names = calloc(len, sizeof(*names));
+
+    // Only print if we were able to retrieve both the names and values.
+    if (xstats != NULL && names != NULL && rte_eth_xstats_get_names(pid, names, len) == len && rte_eth_xstats_get(pid, xstats, len) == len)
+    {
+        fprintf(stdout, "Port %u extended statistics:\n", pid);
+
+        for (i = 0; i < len; i++)
+        {
+            if (xstats[i].value == 0)
+            {
+                continue;
+            }
+
+            fprintf(stdout, "  %s => %llu\n", names[xstats[i].id].name, (unsigned long long)xstats[i].value);
+        }
+    }
+
+    free(xstats);
+    free(names);
+}
+
+/**
+ * Prints how long each startup phase took (EAL, mbuf pools, ports and link wait) along with each port's configure, queue setup and start time.
+ * 
+ * @return Void
+**/
+void dpdkc_startup_timing_print()
+{
+    unsigned int i;
+
+    fprintf(stdout, "Startup timing => EAL %.1f ms, mbuf pools %.1f ms, ports %.1f ms, link wait %.1f ms.\n", init_phase_ns[INIT_PHASE_EAL] / 1e6, init_phase_ns[INIT_PHASE_MBUF] / 1e6, init_phase_ns[INIT_PHASE_PORTS] / 1e6, init_phase_ns[INIT_PHASE_LINK] / 1e6);
+
+    for (i = 0; i < nb_port_init_list; i++)
+    {
+        __u16 pid = port_init_list[i];
+
+        fprintf(stdout, "    Port #%u => configure %.1f ms, queues %.1f ms, start %.1f ms.\n", pid, port_init_ns[pid][PORT_PHASE_CONFIGURE] / 1e6, port_init_ns[pid][PORT_PHASE_QUEUES] / 1e6, port_init_ns[pid][PORT_PHASE_START] / 1e6);
+    }
+}
+
+/**
+ * Fills in the L4 offset, protocol, 5-tuple and ports of an IPv4 packet.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param data A pointer to the start of the packet.
+ * @param len The length of the packet's first segment.
+ * @param off The offset of the IPv4 header.
+ * @param meta A pointer to the burst's metadata.
+ * @param i The packet's index within the burst.
+ * 
+ * @return Void
+**/
+static inline void dpdkc_classify_ipv4(const __u8 *data, __u16 len, __u16 off, struct dpdkc_pkt_meta *meta, unsigned int i)
+{
+    const struct rte_ipv4_hdr *iph = (const struct rte_ipv4_hdr *)(data + off);
+    const struct rte_udp_hdr *l4h;
+    __u16 l4_off = off + (iph->version_ihl & RTE_IPV4_HDR_IHL_MASK) * RTE_IPV4_IHL_MULTIPLIER;
+
+    meta->l4_proto[i] = iph->next_proto_id;
+    meta->src_ip[i] = iph->src_addr;
+    meta->dst_ip[i] = iph->dst_addr;
+
+    // Only the first fragment carries the L4 header.
+    if ((iph->fragment_offset & rte_cpu_to_be_16(RTE_IPV4_HDR_OFFSET_MASK)) != 0)
+    {
+        return;
+    }
+
+    meta->l4_off[i] = l4_off;
+
+    // TCP and UDP both start with the source and destination ports.
+    if ((iph->next_proto_id == IPPROTO_TCP || iph->next_proto_id == IPPROTO_UDP) && l4_off + 4 <= len)
+    {
+        l4h = (const struct rte_udp_hdr *)(data + l4_off);
+
+        meta->src_port[i] = l4h->src_port;
+        meta->dst_port[i] = l4h->dst_port;
+    }
+}
+
+/**
+ * Classifies a single packet of a burst (any ether type).
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param m A pointer to the packet's mbuf.
+ * @param meta A pointer to the burst's metadata.
+ * @param i The packet's index within the burst.
+ * 
+ * @return Void
+**/
+static inline void dpdkc_classify_one(struct rte_mbuf *m, struct dpdkc_pkt_meta *meta, unsigned int i)
+{
+    const __u8 *data = rte_pktmbuf_mtod(m, const __u8 *);
+    const struct rte_ipv6_hdr *ip6h;
+    const struct rte_udp_hdr *l4h;
+    __u16 len = rte_pktmbuf_data_len(m);
+    __u16 off = sizeof(struct rte_ether_hdr);
+    __u16 ether_type;
+    unsigned int vlans;
+
+    meta->ether_type[i] = 0;
+    meta->l3_off[i] = 0;
+    meta->l4_off[i] = 0;
+    meta->l4_proto[i] = 0;
+    meta->src_ip[i] = 0;
+    meta->dst_ip[i] = 0;
+    meta->src_port[i] = 0;
+    meta->dst_port[i] = 0;
+    meta->rss[i] = (m->ol_flags & RTE_MBUF_F_RX_RSS_HASH) ? m->hash.rss : 0;
+
+    if (unlikely(len < sizeof(struct rte_ether_hdr)))
+    {
+        return;
+    }
+
+    ether_type = ((const struct rte_ether_hdr *)data)->ether_type;
+
+    // Skip VLAN/QinQ tags.
+    for (vlans = 0; vlans < CLASSIFY_MAX_VLANS && (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN) || ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_QINQ)) && off + sizeof(struct rte_vlan_hdr) <= len; vlans++)
+    {
+        ether_type = ((const struct rte_vlan_hdr *)(data + off))->eth_proto;
+        off += sizeof(struct rte_vlan_hdr);
+    }
+
+    meta->ether_type[i] = rte_be_to_cpu_16(ether_type);
+    meta->l3_off[i] = off;
+
+    if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) && off + sizeof(struct rte_ipv4_hdr) <= len)
+    {
+        dpdkc_classify_ipv4(data, len, off, meta, i);
+    }
+    else if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6) && off + sizeof(struct rte_ipv6_hdr) <= len)
+    {
+        // IPv6 addresses are read through l3_off. Extension headers aren't walked.
+        ip6h = (const struct rte_ipv6_hdr *)(data + off);
+
+        meta->l4_proto[i] = ip6h->proto;
+        meta->l4_off[i] = off + sizeof(struct rte_ipv6_hdr);
+
+        if ((ip6h->proto == IPPROTO_TCP || ip6h->proto == IPPROTO_UDP) && meta->l4_off[i] + 4 <= len)
+        {
+            l4h = (const struct rte_udp_hdr *)(data + meta->l4_off[i]);
+
+            meta->src_port[i] = l4h->src_port;
+            meta->dst_port[i] = l4h->dst_port;
+        }
+    }
+}
+
+/**
+ * Classifies a burst of packets in place (no packet data is copied) and fills in the burst's metadata (offsets, ether type, L4 protocol, IPv4 addresses, ports and RSS hash).
+ * Addresses and ports are stored in network byte order. Only the first segment of each packet is parsed.
+ * 
+ * @param pkts A pointer to the burst's mbufs.
+ * @param nb_pkts The amount of packets (at most MAX_PCKT_BURST).
+ * @param meta A pointer to the metadata to fill in.
+ * 
+ * @return Void
+**/
+void dpdkc_classify_burst(struct rte_mbuf **pkts, __u16 nb_pkts, struct dpdkc_pkt_meta *meta)
+{
+    unsigned int i = 0, j;
+
+    nb_pkts = RTE_MIN(nb_pkts, MAX_PCKT_BURST);
+    meta->nb_pkts = nb_pkts;
+
+    // Prefetch the first packets' headers.
+    for (j = 0; j < CLASSIFY_PREFETCH_OFFSET && j < nb_pkts; j++)
+    {
+        rte_prefetch0(rte_pktmbuf_mtod(pkts[j], void *));
+    }
+
+#if defined(RTE_ARCH_X86) && defined(__SSE2__)
+    // Check the ether type and length of eight packets at once. Groups that are entirely untagged IPv4 take the straight-line path.
+    const __m128i ipv4_type = _mm_set1_epi16((short)rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4));
+    const __m128i min_len = _mm_set1_epi16(sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv4_hdr) + 4 - 1);
+
+    for (; i + 8 <= nb_pkts; i += 8)
+    {
+        __m128i types, lens, ok;
+
+        for (j = 0; j < 8 && i + CLASSIFY_PREFETCH_OFFSET + j < nb_pkts; j++)
+        {
+            rte_prefetch0(rte_pktmbuf_mtod(pkts[i + CLASSIFY_PREFETCH_OFFSET + j], void *));
+        }
+
+        types = _mm_setr_epi16(rte_pktmbuf_mtod(pkts[i], struct rte_ether_hdr *)->ether_type, rte_pktmbuf_mtod(pkts[i + 1], struct rte_ether_hdr *)->ether_type,
+                               rte_pktmbuf_mtod(pkts[i + 2], struct rte_ether_hdr *)->ether_type, rte_pktmbuf_mtod(pkts[i + 3], struct rte_ether_hdr *)->ether_type,
+                               rte_pktmbuf_mtod(pkts[i + 4], struct rte_ether_hdr *)->ether_type, rte_pktmbuf_mtod(pkts[i + 5], struct rte_ether_hdr *)->ether_type,
+                               rte_pktmbuf_mtod(pkts[i + 6], struct rte_ether_hdr *)->ether_type, rte_pktmbuf_mtod(pkts[i + 7], struct rte_ether_hdr *)->ether_type);
+
+        lens = _mm_setr_epi16(pkts[i]->data_len, pkts[i + 1]->data_len, pkts[i + 2]->data_len, pkts[i + 3]->data_len,
+                              pkts[i + 4]->data_len, pkts[i + 5]->data_len, pkts[i + 6]->data_len, pkts[i + 7]->data_len);
+
+        // A lane is OK if it's IPv4 and long enough for the Ethernet, IPv4 and first four L4 bytes (unsigned saturating subtraction is non-zero).
+        ok = _mm_andnot_si128(_mm_cmpeq_epi16(_mm_subs_epu16(lens, min_len), _mm_setzero_si128()), _mm_cmpeq_epi16(types, ipv4_type));
+
+        if (_mm_movemask_epi8(ok) == 0xFFFF)
+        {
+            for (j = i; j < i + 8; j++)
+            {
+                meta->ether_type[j] = RTE_ETHER_TYPE_IPV4;
+                meta->l3_off[j] = sizeof(struct rte_ether_hdr);
+                meta->l4_off[j] = 0;
+                meta->src_port[j] = 0;
+                meta->dst_port[j] = 0;
+                meta->rss[j] = (pkts[j]->ol_flags & RTE_MBUF_F_RX_RSS_HASH) ? pkts[j]->hash.rss : 0;
+
+                dpdkc_classify_ipv4(rte_pktmbuf_mtod(pkts[j], const __u8 *), pkts[j]->data_len, sizeof(struct rte_ether_hdr), meta, j);
+            }
+        }
+        else
+        {
+            for (j = i; j < i + 8; j++)
+            {
+                dpdkc_classify_one(pkts[j], meta, j);
+            }
+        }
+    }
+#endif
+
+    for (; i < nb_pkts; i++)
+    {
+        if (i + CLASSIFY_PREFETCH_OFFSET < nb_pkts)
+        {
+            rte_prefetch0(rte_pktmbuf_mtod(pkts[i + CLASSIFY_PREFETCH_OFFSET], void *));
+        }
+
+        dpdkc_classify_one(pkts[i], meta, i);
+    }
+}
+
+/**
+ * Returns whether or not a flow rule matches on IPv4 or L4 fields.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param rule A pointer to the flow rule.
+ * 
+ * @return 1 if the rule matches on IPv4 or L4 fields or 0 otherwise.
+**/
+static inline int dpdkc_flow_rule_has_ip(const struct dpdkc_flow_rule *rule)
+{
+    return rule->src_mask != 0 || rule->dst_mask != 0 || rule->l4_proto != 0 || rule->src_port != 0 || rule->dst_port != 0;
+}
+
+/**
+ * Checks a flow rule's description and builds its rte_flow attributes, pattern and actions.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param rule A pointer to the flow rule.
+ * @param spec A pointer to the rte_flow storage to fill in.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+static struct dpdkc_ret dpdkc_flow_rule_build(const struct dpdkc_flow_rule *rule, struct dpdkc_flow_spec *spec)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    unsigned int nb_items = 0;
+    int has_ip = dpdkc_flow_rule_has_ip(rule);
+    unsigned int i;
+
+    ret.port_id = rule->port_id;
+
+    if (rule->port_id >= RTE_MAX_ETHPORTS || !rte_eth_dev_is_valid_port(rule->port_id))
+    {
+        ret.err_num = -ENODEV;
+        ret.gen_msg = "Invalid port for flow rule.";
+
+        return ret;
+    }
+
+    if (has_ip && rule->ether_type != 0 && rule->ether_type != RTE_ETHER_TYPE_IPV4)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Flow rule IP fields require an IPv4 ether type.";
+
+        return ret;
+    }
+
+    if ((rule->src_port != 0 || rule->dst_port != 0) && rule->l4_proto != IPPROTO_TCP && rule->l4_proto != IPPROTO_UDP)
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Flow rule ports require TCP or UDP.";
+
+        return ret;
+    }
+
+    if (rule->action == FLOW_ACTION_RSS && (rule->rss_nb_queues == 0 || rule->rss_nb_queues > FLOW_RSS_MAX_QUEUES))
+    {
+        ret.err_num = -EINVAL;
+        ret.gen_msg = "Invalid flow rule RSS queue count.";
+
+        return ret;
+    }
+
+    memset(spec, 0, sizeof(*spec));
+
+    spec->attr.ingress = 1;
+    spec->attr.priority = rule->priority;
+
+    // Ethernet (optionally matching the ether type).
+    spec->pattern[nb_items].type = RTE_FLOW_ITEM_TYPE_ETH;
+
+    if (rule->ether_type != 0 || has_ip)
+    {
+        spec->eth_spec.type = rte_cpu_to_be_16(has_ip ? RTE_ETHER_TYPE_IPV4 : rule->ether_type);
+        spec->eth_mask.type = 0xFFFF;
+
+        spec->pattern[nb_items].spec = &spec->eth_spec;
+        spec->pattern[nb_items].mask = &spec->eth_mask;
+    }
+
+    nb_items++;
+
+    // IPv4.
+    if (has_ip)
+    {
+        spec->ip_spec.hdr.src_addr = rule->src_ip & rule->src_mask;
+        spec->ip_mask.hdr.src_addr = rule->src_mask;
+        spec->ip_spec.hdr.dst_addr = rule->dst_ip & rule->dst_mask;
+        spec->ip_mask.hdr.dst_addr = rule->dst_mask;
+        spec->ip_spec.hdr.next_proto_id = rule->l4_proto;
+        spec->ip_mask.hdr.next_proto_id = (rule->l4_proto != 0) ? 0xFF : 0;
+
+        spec->pattern[nb_items].type = RTE_FLOW_ITEM_TYPE_IPV4;
+        spec->pattern[nb_items].spec = &spec->ip_spec;
+        spec->pattern[nb_items].mask = &spec->ip_mask;
+
+        nb_items++;
+    }
+
+    // TCP/UDP ports.
+    if (rule->l4_proto == IPPROTO_TCP)
+    {
+        spec->tcp_spec.hdr.src_port = rule->src_port;
+        spec->tcp_mask.hdr.src_port = (rule->src_port != 0) ? 0xFFFF : 0;
+        spec->tcp_spec.hdr.dst_port = rule->dst_port;
+        spec->tcp_mask.hdr.dst_port = (rule->dst_port != 0) ? 0xFFFF : 0;
+
+        spec->pattern[nb_items].type = RTE_FLOW_ITEM_TYPE_TCP;
+        spec->pattern[nb_items].spec = &spec->tcp_spec;
+        spec->pattern[nb_items].mask = &spec->tcp_mask;
+
+        nb_items++;
+    }
+    else if (rule->l4_proto == IPPROTO_UDP)
+    {
+        spec->udp_spec.hdr.src_port = rule->src_port;
+        spec->udp_mask.hdr.src_port = (rule->src_port != 0) ? 0xFFFF : 0;
+        spec->udp_spec.hdr.dst_port = rule->dst_port;
+        spec->udp_mask.hdr.dst_port = (rule->dst_port != 0) ? 0xFFFF : 0;
+
+        spec->pattern[nb_items].type = RTE_FLOW_ITEM_TYPE_UDP;
+        spec->pattern[nb_items].spec = &spec->udp_spec;
+        spec->pattern[nb_items].mask = &spec->udp_mask;
+
+        nb_items++;
+    }
+
+    spec->pattern[nb_items].type = RTE_FLOW_ITEM_TYPE_END;
+
+    // Action.
+    switch (rule->action)
+    {
+        case FLOW_ACTION_DROP:
+            spec->actions[0].type = RTE_FLOW_ACTION_TYPE_DROP;
+
+            break;
+
+        case FLOW_ACTION_QUEUE:
+            spec->queue.index = rule->queue;
+
+            spec->actions[0].type = RTE_FLOW_ACTION_TYPE_QUEUE;
+            spec->actions[0].conf = &spec->queue;
+
+            break;
+
+        case FLOW_ACTION_MARK:
+            spec->mark.id = rule->mark;
+
+            spec->actions[0].type = RTE_FLOW_ACTION_TYPE_MARK;
+            spec->actions[0].conf = &spec->mark;
+
+            break;
+
+        case FLOW_ACTION_RSS:
+            for (i = 0; i < rule->rss_nb_queues; i++)
+            {
+                spec->rss_queues[i] = rule->rss_queue_start + i;
+            }
+
+            spec->rss.types = rss_hf;
+            spec->rss.queue_num = rule->rss_nb_queues;
+            spec->rss.queue = spec->rss_queues;
+
+            spec->actions[0].type = RTE_FLOW_ACTION_TYPE_RSS;
+            spec->actions[0].conf = &spec->rss;
+
+            break;
+
+        default:
+            ret.err_num = -EINVAL;
+            ret.gen_msg = "Invalid flow rule action.";
+
+            return ret;
+    }
+
+    spec->actions[1].type = RTE_FLOW_ACTION_TYPE_END;
+
+    return ret;
+}
+
+/**
+ * Validates a flow rule against the port's PMD without installing it.
+ * 
+ * @param rule A pointer to the flow rule.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret).
+**/
+struct dpdkc_ret dpdkc_flow_rule_validate(const struct dpdkc_flow_rule *rule)
+{
+    struct dpdkc_flow_spec spec;
+    struct rte_flow_error error;
+
+    // Build the rule and check.
+    struct dpdkc_ret ret = dpdkc_flow_rule_build(rule, &spec);
+
+    if (ret.err_num != 0)
+    {
+        return ret;
+    }
+
+    memset(&error, 0, sizeof(error));
+
+    if ((ret.err_num = rte_flow_validate(rule->port_id, &spec.attr, spec.pattern, spec.actions, &error)) != 0)
+    {
+        ret.gen_msg = (error.message != NULL) ? (char *)error.message : "Flow rule rejected by the PMD.";
+    }
+
+    return ret;
+}
+
+/**
+ * Adds a flow rule to its port's software fallback list (kept sorted by priority).
+ * WARNING - Static function (cannot use outside of this file).
+ * NOTE - The caller must hold reconf_lock.
+ * 
+ * @param id The flow rule ID.
+ * 
+ * @return Void
+**/
+static void dpdkc_flow_sw_add(__u16 id)
+{
+    __u16 pid = flow_rules[id].rule.port_id;
+    unsigned int i = ports[pid].nb_sw_flow_rules;
+
+    // Shift lower priority (higher value) rules back.
+    while (i > 0 && flow_rules[sw_flow_rule_ids[pid][i - 1]].rule.priority > flow_rules[id].rule.priority)
+    {
+        sw_flow_rule_ids[pid][i] = sw_flow_rule_ids[pid][i - 1];
+        i--;
+    }
+
+    sw_flow_rule_ids[pid][i] = id;
+
+    ports[pid].nb_sw_flow_rules++;
+}
+
+/**
+ * Removes a flow rule from its port's software fallback list.
+ * WARNING - Static function (cannot use outside of this file).
+ * NOTE - The caller must hold reconf_lock.
+ * 
+ * @param id The flow rule ID.
+ * 
+ * @return Void
+**/
+static void dpdkc_flow_sw_del(__u16 id)
+{
+    __u16 pid = flow_rules[id].rule.port_id;
+    unsigned int i, j;
+
+    for (i = 0; i < ports[pid].nb_sw_flow_rules; i++)
+    {
+        if (sw_flow_rule_ids[pid][i] != id)
+        {
+            continue;
+        }
+
+        for (j = i + 1; j < ports[pid].nb_sw_flow_rules; j++)
+        {
+            sw_flow_rule_ids[pid][j - 1] = sw_flow_rule_ids[pid][j];
+        }
+
+        ports[pid].nb_sw_flow_rules--;
+
+        break;
+    }
+}
+
+/**
+ * Installs a flow rule in the port's NIC. If the PMD rejects it (or the port's known rule capacity is reached), DROP and MARK rules may fall back to software filtering through dpdkc_flow_sw_filter().
+ * NOTE - Software rules reach the fast path through the published forwarding config, so they may be installed and removed while the port is polled (the call blocks for a grace period).
+ * 
+ * @param rule A pointer to the flow rule.
+ * @param sw_fallback If 1, fall back to a software rule if the NIC doesn't take it.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The rule ID is stored in ret.data and its handle in ret.dataptr.
+**/
+struct dpdkc_ret dpdkc_flow_rule_install(const struct dpdkc_flow_rule *rule, int sw_fallback)
+{
+    struct dpdkc_flow_spec spec;
+    struct rte_flow_error error;
+    struct rte_flow *flow = NULL;
+    struct port_conf *port;
+    struct dpdkc_fwd_conf *old = NULL;
+    int hw_err = -ENOSPC;
+    __u32 id;
+
+    // Build the rule and check.
+    struct dpdkc_ret ret = dpdkc_flow_rule_build(rule, &spec);
+
+    if (ret.err_num != 0)
+    {
+        return ret;
+    }
+
+    // The rule tables are only changed together with republishing them.
+    pthread_mutex_lock(&reconf_lock);
+
+    // Find a free rule slot.
+    for (id = 0; id < MAX_FLOW_RULES; id++)
+    {
+        if (!flow_rules[id].used)
+        {
+            break;
+        }
+    }
+
+    if (id >= MAX_FLOW_RULES)
+    {
+        pthread_mutex_unlock(&reconf_lock);
+
+        ret.err_num = -ENOSPC;
+        ret.gen_msg = "No free flow rule slots.";
+
+        return ret;
+    }
+
+    port = &ports[rule->port_id];
+
+    // Only try the NIC if we haven't already hit its capacity.
+    if (port->hw_flow_rule_limit == 0 || port->nb_hw_flow_rules < port->hw_flow_rule_limit)
+    {
+        memset(&error, 0, sizeof(error));
+
+        flow = rte_flow_create(rule->port_id, &spec.attr, spec.pattern, spec.actions, &error);
+
+        if (flow == NULL)
+        {
+            hw_err = -rte_errno;
+
+            // Remember the capacity once the NIC runs out of room.
+            if (rte_errno == ENOSPC || rte_errno == ENOMEM)
+            {
+                port->hw_flow_rule_limit = port->nb_hw_flow_rules;
+            }
+
+            fprintf(stdout, "WARNING - Port #%u rejected flow rule (%s).\n", rule->port_id, (error.message != NULL) ? error.message : "unknown error");
+        }
+    }
+
+    if (flow == NULL)
+    {
+        // Steering can't be done after the packet was received.
+        if (!sw_fallback || rule->action == FLOW_ACTION_QUEUE || rule->action == FLOW_ACTION_RSS)
+        {
+            pthread_mutex_unlock(&reconf_lock);
+
+            ret.err_num = hw_err;
+            ret.gen_msg = "Failed to install flow rule in hardware.";
+
+            return ret;
+        }
+
+        if (port->nb_sw_flow_rules >= MAX_FLOW_RULES)
+        {
+            pthread_mutex_unlock(&reconf_lock);
+
+            ret.err_num = -ENOSPC;
+            ret.gen_msg = "No free software flow rule slots on port.";
+
+            return ret;
+        }
+    }
+
+    flow_rules[id].used = 1;
+    flow_rules[id].in_hw = (flow != NULL);
+    flow_rules[id].rule = *rule;
+    flow_rules[id].flow = flow;
+
+    if (flow != NULL)
+    {
+        port->nb_hw_flow_rules++;
+    }
+    else
+    {
+        dpdkc_flow_sw_add(id);
+
+        // Running l-cores only see the rule once it's republished.
+        if (dpdkc_fwd_conf_get() != NULL && dpdkc_fwd_conf_refresh_rules(&old) != 0)
+        {
+            fprintf(stdout, "WARNING - Failed to republish software flow rules (rule #%u applies on the next launch).\n", id);
+        }
+    }
+
+    pthread_mutex_unlock(&reconf_lock);
+
+    dpdkc_fwd_conf_retire(old);
+
+    ret.data = id;
+    ret.dataptr = &flow_rules[id];
+
+    return ret;
+}
+
+/**
+ * Removes an installed flow rule.
+ * 
+ * @param id The flow rule ID returned by dpdkc_flow_rule_install().
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). The rule stays installed on failure.
+**/
+struct dpdkc_ret dpdkc_flow_rule_remove(__u32 id)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+    struct rte_flow_error error;
+    struct dpdkc_flow_handle *handle;
+    struct dpdkc_fwd_conf *old = NULL;
+
+    if (id >= MAX_FLOW_RULES)
+    {
+        ret.err_num = -ENOENT;
+        ret.gen_msg = "Flow rule not found.";
+
+        return ret;
+    }
+
+    // The rule tables are only changed together with republishing them.
+    pthread_mutex_lock(&reconf_lock);
+
+    if (!flow_rules[id].used)
+    {
+        pthread_mutex_unlock(&reconf_lock);
+
+        ret.err_num = -ENOENT;
+        ret.gen_msg = "Flow rule not found.";
+
+        return ret;
+    }
+
+    handle = &flow_rules[id];
+    ret.port_id = handle->rule.port_id;
+
+    if (handle->in_hw)
+    {
+        memset(&error, 0, sizeof(error));
+
+        if ((ret.err_num = rte_flow_destroy(handle->rule.port_id, handle->flow, &error)) != 0)
+        {
+            pthread_mutex_unlock(&reconf_lock);
+
+            ret.gen_msg = "Failed to destroy flow rule.";
+
+            return ret;
+        }
+
+        ports[handle->rule.port_id].nb_hw_flow_rules--;
+    }
+    else
+    {
+        dpdkc_flow_sw_del(id);
+
+        // Keep the rule installed if running l-cores can't be told it's gone.
+        if (dpdkc_fwd_conf_get() != NULL && (ret.err_num = dpdkc_fwd_conf_refresh_rules(&old)) != 0)
+        {
+            dpdkc_flow_sw_add(id);
+
+            pthread_mutex_unlock(&reconf_lock);
+
+            ret.gen_msg = "Failed to republish software flow rules (the rule stays installed).";
+
+            return ret;
+        }
+    }
+
+    memset(handle, 0, sizeof(*handle));
+
+    pthread_mutex_unlock(&reconf_lock);
+
+    dpdkc_fwd_conf_retire(old);
+
+    return ret;
+}
+
+/**
+ * Drops a flow rule's bookkeeping without asking the PMD (used when the port's device is gone).
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param id The flow rule ID.
+ * 
+ * @return Void
+**/
+static void dpdkc_flow_rule_forget(__u32 id)
+{
+    struct dpdkc_flow_handle *handle = &flow_rules[id];
+    struct dpdkc_fwd_conf *old = NULL;
+
+    pthread_mutex_lock(&reconf_lock);
+
+    if (handle->used)
+    {
+        if (handle->in_hw)
+        {
+            ports[handle->rule.port_id].nb_hw_flow_rules--;
+        }
+        else
+        {
+            dpdkc_flow_sw_del(id);
+
+            // The port isn't polled anymore, so a stale copy in the published config is harmless if this fails.
+            if (dpdkc_fwd_conf_get() != NULL)
+            {
+                dpdkc_fwd_conf_refresh_rules(&old);
+            }
+        }
+
+        memset(handle, 0, sizeof(*handle));
+    }
+
+    pthread_mutex_unlock(&reconf_lock);
+
+    dpdkc_fwd_conf_retire(old);
+}
+
+/**
+ * Removes all flow rules installed on a port.
+ * NOTE - Rules of a removed port are forgotten even if the PMD fails to destroy them, so a port re-attached with the same ID starts clean.
+ * 
+ * @param pid The port ID.
+ * 
+ * @return Void
+**/
+void dpdkc_flow_rules_flush(__u16 pid)
+{
+    int removed = (__atomic_load_n(&ports[pid].state, __ATOMIC_ACQUIRE) == PORT_STATE_REMOVED);
+    __u32 id;
+
+    for (id = 0; id < MAX_FLOW_RULES; id++)
+    {
+        if (flow_rules[id].used && flow_rules[id].rule.port_id == pid && dpdkc_flow_rule_remove(id).err_num != 0 && removed)
+        {
+            dpdkc_flow_rule_forget(id);
+        }
+    }
+
+    pthread_mutex_lock(&reconf_lock);
+    ports[pid].hw_flow_rule_limit = 0;
+    pthread_mutex_unlock(&reconf_lock);
+}
+
+/**
+ * Matches a packet against a software flow rule.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param rule A pointer to the flow rule.
+ * @param m A pointer to the packet's mbuf.
+ * 
+ * @return 1 if the packet matches or 0 otherwise.
+**/
+static inline int dpdkc_flow_sw_match(const struct dpdkc_flow_rule *rule, const struct rte_mbuf *m)
+{
+    const __u8 *data = rte_pktmbuf_mtod(m, const __u8 *);
+    const struct rte_ipv4_hdr *iph;
+    const struct rte_udp_hdr *l4h;
+    __u16 len = rte_pktmbuf_data_len(m);
+    __u16 ether_type, l4_off;
+
+    if (len < sizeof(struct rte_ether_hdr))
+    {
+        return 0;
+    }
+
+    ether_type = ((const struct rte_ether_hdr *)data)->ether_type;
+
+    if (rule->ether_type != 0 && ether_type != rte_cpu_to_be_16(rule->ether_type))
+    {
+        return 0;
+    }
+
+    if (!dpdkc_flow_rule_has_ip(rule))
+    {
+        return 1;
+    }
+
+    if (ether_type != rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) || len < sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv4_hdr))
+    {
+        return 0;
+    }
+
+    iph = (const struct rte_ipv4_hdr *)(data + sizeof(struct rte_ether_hdr));
+
+    if (((iph->src_addr ^ rule->src_ip) & rule->src_mask) != 0 || ((iph->dst_addr ^ rule->dst_ip) & rule->dst_mask) != 0)
+    {
+        return 0;
+    }
+
+    if (rule->l4_proto != 0 && iph->next_proto_id != rule->l4_proto)
+    {
+        return 0;
+    }
+
+    if (rule->src_port == 0 && rule->dst_port == 0)
+    {
+        return 1;
+    }
+
+    // Non-first fragments have no ports.
+    if ((iph->fragment_offset & rte_cpu_to_be_16(RTE_IPV4_HDR_OFFSET_MASK)) != 0)
+    {
+        return 0;
+    }
+
+    l4_off = sizeof(struct rte_ether_hdr) + (iph->version_ihl & RTE_IPV4_HDR_IHL_MASK) * RTE_IPV4_IHL_MULTIPLIER;
+
+    if (l4_off + 4 > len)
+    {
+        return 0;
+    }
+
+    l4h = (const struct rte_udp_hdr *)(data + l4_off);
+
+    return (rule->src_port == 0 || l4h->src_port == rule->src_port) && (rule->dst_port == 0 || l4h->dst_port == rule->dst_port);
+}
+
+/**
+ * Applies a port's software fallback flow rules (from the published forwarding config) to a burst. Dropped packets are freed and marked packets get the mark in hash.fdir.hi with RTE_MBUF_F_RX_FDIR_ID set (like a hardware MARK action).
+ * NOTE - Custom l-core loops must be registered with dpdkc_lcore_online().
+ * 
+ * @param pid The port ID the burst was received on.
+ * @param pkts A pointer to the burst's mbufs (kept packets are moved to the front).
+ * @param nb_pkts The amount of packets.
+ * 
+ * @return The amount of packets left.
+**/
+__u16 dpdkc_flow_sw_filter(__u16 pid, struct rte_mbuf **pkts, __u16 nb_pkts)
+{
+    const struct dpdkc_fwd_conf *conf = dpdkc_fwd_conf_get();
+    const struct dpdkc_flow_rule *rules, *rule;
+    unsigned int nb_rules, i, j;
+    __u16 nb_keep = 0;
+
+    if (conf == NULL || conf->nb_sw_rules[pid] == 0)
+    {
+        return nb_pkts;
+    }
+
+    rules = &conf->sw_rules[conf->sw_rule_start[pid]];
+    nb_rules = conf->nb_sw_rules[pid];
+
+    for (i = 0; i < nb_pkts; i++)
+    {
+        // The first (highest priority) matching rule wins.
+        for (j = 0; j < nb_rules; j++)
+        {
+            rule = &rules[j];
+
+            if (dpdkc_flow_sw_match(rule, pkts[i]))
+            {
+                break;
+            }
+        }
+
+        if (j < nb_rules && rule->action == FLOW_ACTION_DROP)
+        {
+            rte_pktmbuf_free(pkts[i]);
+
+            continue;
+        }
+
+        if (j < nb_rules && rule->action == FLOW_ACTION_MARK)
+        {
+            pkts[i]->hash.fdir.hi = rule->mark;
+            pkts[i]->ol_flags |= RTE_MBUF_F_RX_FDIR | RTE_MBUF_F_RX_FDIR_ID;
+        }
+
+        pkts[nb_keep++] = pkts[i];
+    }
+
+    return nb_keep;
+}
+
+#ifdef USE_LATENCY_HIST
+/**
+ * Retrieves the upper bound (in TSC cycles) of a latency histogram bucket.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param idx The bucket index.
+ * 
+ * @return The highest amount of cycles recorded into the bucket.
+**/
+static __u64 dpdkc_latency_hist_bucket_max(unsigned int idx)
+{
+    unsigned int msb, sub;
+
+    if (idx < (1 << LATENCY_HIST_SUB_BITS))
+    {
+        return idx;
+    }
+
+    msb = (idx >> LATENCY_HIST_SUB_BITS) + LATENCY_HIST_SUB_BITS - 1;
+    sub = idx & ((1 << LATENCY_HIST_SUB_BITS) - 1);
+
+    return (1ULL << msb) + ((__u64)(sub + 1) << (msb - LATENCY_HIST_SUB_BITS)) - 1;
+}
+
+/**
+ * Retrieves the upper bound of the bucket a percentile of a histogram falls into.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param buckets A pointer to the histogram's buckets.
+ * @param count The amount of samples in the histogram.
+ * @param pct The percentile (0 - 100).
+ * 
+ * @return The percentile in TSC cycles.
+**/
+static __u64 dpdkc_latency_hist_percentile(const __u64 *buckets, __u64 count, double pct)
+{
+    __u64 target = (__u64)(count * pct / 100.0);
+    __u64 seen = 0;
+    unsigned int i;
+
+    for (i = 0; i < LATENCY_HIST_BUCKETS; i++)
+    {
+        seen += buckets[i];
+
+        if (seen > target)
+        {
+            return dpdkc_latency_hist_bucket_max(i);
+        }
+    }
+
+    return dpdkc_latency_hist_bucket_max(LATENCY_HIST_BUCKETS - 1);
+}
+
+/**
+ * Prints the p50/p99/p99.9/max latency of every histogram on every l-core that recorded samples.
+ * 
+ * @return Void
+**/
+void dpdkc_latency_hist_dump()
+{
+    static const char *names[HIST_MAX] = { "RX burst", "Callback", "TX flush" };
+
+    struct dpdkc_latency_hist *hist;
+    double ns_per_cycle = (double)NS_PER_S / rte_get_tsc_hz();
+    unsigned int lcore;
+    int type;
+
+    fprintf(stdout, "\n==== Latency (TSC cycles / ns) ====\n");
+
+    RTE_LCORE_FOREACH(lcore)
+    {
+        hist = &lcore_hist[lcore];
+
+        for (type = 0; type < HIST_MAX; type++)
+        {
+            __u64 p50, p99, p999;
+
+            if (hist->count[type] == 0)
+            {
+                continue;
+            }
+
+            p50 = dpdkc_latency_hist_percentile(hist->buckets[type], hist->count[type], 50.0);
+            p99 = dpdkc_latency_hist_percentile(hist->buckets[type], hist->count[type], 99.0);
+            p999 = dpdkc_latency_hist_percentile(hist->buckets[type], hist->count[type], 99.9);
+
+            fprintf(stdout, "L-core %u %s => samples %llu, p50 %llu (%.0f), p99 %llu (%.0f), p99.9 %llu (%.0f), max %llu (%.0f).\n", lcore, names[type], (unsigned long long)hist->count[type], (unsigned long long)p50, p50 * ns_per_cycle, (unsigned long long)p99, p99 * ns_per_cycle, (unsigned long long)p999, p999 * ns_per_cycle, (unsigned long long)hist->max[type], hist->max[type] * ns_per_cycle);
+        }
+    }
+
+    fflush(stdout);
+}
+
+/**
+ * Clears the latency histograms of every l-core.
+ * NOTE - Samples recorded while resetting may be partially lost.
+ * 
+ * @return Void
+**/
+void dpdkc_latency_hist_reset()
+{
+    memset(lcore_hist, 0, sizeof(lcore_hist));
+}
+#endif
+
+/**
+ * Removes the least recently used item from a regular hash table if the table exceeds max entries.
+ * NOTE - The counters are shared by every table and eviction follows slot positions rather than recency. Use the flow table functions (dpdkc_flow_table_*) for new code.
+ * 
+ * @param tbl A pointer to the hash table.
+ * @param max_entries The max entries in the table.
+ * 
+ * @return 0 on success or -1 on error (failed to delete key from table).
+**/
+int check_and_del_lru_from_hash_table(void *tbl, __u32 max_entries)
+{
+    static __u32 cnt = 0;
+    static __s32 pos = 0;
+
+    // Check if the entry count exceeds max entries.
+    if (cnt > max_entries)
+    {
+        // Check if the position needs to be reset.
+        if (pos >= (max_entries - 1))
+        {
+            pos = 0;
+        }
+
+        void *key;
+
+        if (rte_hash_get_key_with_position(tbl, pos, (void **)&key))
+        {
+#ifdef DEBUG
+            printf("Failed to get key %u.\n", pos);
+#endif
+        }
+
+        // Try deleting it.
+        if (rte_hash_del_key(tbl, key) < 0)
+        {
+#ifdef DEBUG
+            printf("Failed at %u.\n", pos);
+#endif
+
+            return -1;
+        }
+
+#ifdef DEBUG
+        printf("Removed at position at %u.\n", pos);
+#endif
+
+        pos++;
+    }
+
+    if (cnt <= max_entries)
+    {
+        cnt++;
+    }
+
+    return 0;
+}
+
+/**
+ * Retrieves a pointer to the entry (last seen timestamp and ownership state followed by user data) at a hash table position.
+ * WARNING - Static function (cannot use outside of this file).
+ * 
+ * @param tbl A pointer to the flow table.
+ * @param pos The key's position within the hash table.
+ * 
+ * @return A pointer to the entry's last seen timestamp.
+**/
+static inline __u64 *dpdkc_flow_table_entry(struct dpdkc_flow_table *tbl, __s32 pos)
+{
+    return (__u64 *)(tbl->entries + (size_t)pos * tbl->entry_size);
+}
+
+/**
+ * Creates a flow table (lock-free hash table with per-entry last seen timestamps and incremental aging).
+ * NOTE - Register every l-core that accesses the table with dpdkc_flow_table_register() before it does so.
+ * 
+ * @param name The name of the table (must be unique).
+ * @param max_entries The max entries in the table.
+ * @param key_len The length of each key.
+ * @param data_size The size of the user data stored with each entry.
+ * @param timeout_us The amount of microseconds an entry may be idle before it is aged out.
+ * @param socket_id The NUMA socket to allocate the table on.
+ * 
+ * @return The DPDK Common return structure (struct dpdkc_ret). A pointer to the table (struct dpdkc_flow_table) is stored in ret->dataptr.
+**/
+struct dpdkc_ret dpdkc_flow_table_create(const char *name, __u32 max_entries, __u32 key_len, __u32 data_size, __u64 timeout_us, int socket_id)
+{
+    // Create DPDK Common's return structure.
+    struct dpdkc_ret ret = dpdkc_ret_init();
+
+    struct dpdkc_flow_table *tbl;
+    struct rte_hash_parameters params = {0};
+    struct rte_hash_rcu_config rcu_conf = {0};
+
+    tbl = rte_zmalloc_socket("flow_table", sizeof(*tbl), RTE_CACHE_LINE_SIZE, socket_id);
+
+    if (tbl == NULL)
+    {
+        ret.err_num = -ENOMEM;
+        ret.gen_msg = "Failed to allocate flow table.";
+
+        return ret;
+    }
+
+    // Readers are lock-free and multiple l-cores may add keys at once.
+    params.name = name;
+    params.entries = max_entries;
+    params.key_len = key_len;
+    params.hash_func = rte_jhash;
+    params.hash_func_init_val = 0;
+    params.socket_id = socket_id;
+    params.extra_flag = RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF | RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD;
+
+    if ((tbl->hash = rte_hash_create(&params)) == NULL)
+    {
+        dpdkc_flow_table_free(tbl);
+
+        ret.err_num = -rte_errno;
+        ret.gen_msg = "Failed to create flow table's hash table.";
+
+        return ret;
+    }
+
+    // Deleted keys are only freed once every l-core has passed through a quiescent state.
+    if ((tbl->qsbr = rte_zmalloc_socket("flow_table_qsbr", rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE), RTE_CACHE_LINE_SIZE, socket_id)) == NULL)
+    {
+        dpdkc_flow_table_free(tbl);
+
+        ret.err_num = -ENOMEM;
+        ret.gen_msg = "Failed to allocate flow table's QSBR variable.";
+
+        return ret;
+    }
+
+    // No l-core is registered yet (see dpdkc_flow_table_register()), so keys are freed right away until one is.
+    rte_rcu_qsbr_init(tbl->qsbr, RTE_MAX_LCORE);
+
+    rcu_conf.v = tbl->qsbr;
+    rcu_conf.mode = RTE_HASH_QSBR_MODE_DQ;
+
+    if ((ret.err_num = rte_hash_rcu_qsbr_add(tbl->hash, &rcu_conf)) != 0)
+    {
+        dpdkc_flow_table_free(tbl);
 
-            // Assign port_id and increment count.
-            qconf->rx_port_list[qconf->num_rx_ports] = port_id;
-            qconf->num_rx_ports++;
+        ret.gen_msg = "Failed to attach QSBR variable to flow table.";
 
-        }
+        return ret;
+    }
 
-        // Handle TX ports.
-        if (ports[port_id].tx)
-        {
-            // If we've met the number of ports per l-core or the l-core is disabled, increase the ID.
-            if (lcore_port_conf[tx_lcore_id].num_tx_ports == tx_port_pl || rte_lcore_is_enabled(rx_lcore_id) == 0)
-            {
-                // Increment the lcore ID.
-                tx_lcore_id++;
-            }
+    // Entries are indexed by key position and padded to a cache line so l-cores updating different flows don't share lines.
+    tbl->nb_positions = rte_hash_max_key_id(tbl->hash) + 1;
+    tbl->entry_size = RTE_ALIGN_CEIL(2 * sizeof(__u64) + data_size, RTE_CACHE_LINE_SIZE);
 
-            // If the ID is higher or equal to the maximum lcore count, we need to exit with an error.
-            if (tx_lcore_id >= RTE_MAX_LCORE)
-            {
-                ret.err_num = -1;
-                ret.gen_msg = "Failed due to l-core ID exceeding the maximum amount of l-cores.";
+    if ((tbl->entries = rte_zmalloc_socket("flow_table_entries", (size_t)tbl->nb_positions * tbl->entry_size, RTE_CACHE_LINE_SIZE, socket_id)) == NULL)
+    {
+        dpdkc_flow_table_free(tbl);
 
-                return ret;
-            }
+        ret.err_num = -ENOMEM;
+        ret.gen_msg = "Failed to allocate flow table entries.";
 
-            // Assign pointer to make things easier.
-            qconf = &lcore_port_conf[tx_lcore_id];
+        return ret;
+    }
 
-            // Assign port_id and increment count.
-            qconf->tx_port_list[qconf->num_tx_ports] = port_id;
-            qconf->num_tx_ports++;
+    tbl->timeout_tsc = rte_get_tsc_hz() / US_PER_S * timeout_us;
 
-        }
-    }
+    ret.dataptr = tbl;
 
     return ret;
 }
 
 /**
- * Creates the packet's mbuf pool.
+ * Frees a flow table.
  * 
- * @return The DPDK Common return structure (struct dpdkc_ret).
+ * @param tbl A pointer to the flow table.
+ * 
+ * @return Void
 **/
-struct dpdkc_ret dpdkc_create_mbuf()
+void dpdkc_flow_table_free(struct dpdkc_flow_table *tbl)
 {
-    // Initialize return variable (custom error).
-    struct dpdkc_ret ret = dpdkc_ret_init();
-
-    // Retrieve amount of mbufs to create.
-    unsigned int nb_mbufs = RTE_MAX(nb_ports * (nb_rxd + nb_txd + nb_lcores & MEMPOOL_CACHE_SIZE), 8192U);
-
-    // Create mbuf pool.
-    pcktmbuf_pool = rte_pktmbuf_pool_create("pckt_pool", nb_mbufs, MEMPOOL_CACHE_SIZE, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+    if (tbl == NULL)
+    {
+        return;
+    }
 
-    // Check if the mbuf pool is NULL.
-    if (pcktmbuf_pool == NULL)
+    if (tbl->hash != NULL)
     {
-        ret.gen_msg = "Failed to create packet's mbuf pool.";
-        ret.err_num = -1;
+        rte_hash_free(tbl->hash);
     }
 
-    return ret;
+    rte_free(tbl->qsbr);
+    rte_free(tbl->entries);
+    rte_free(tbl);
 }
 
 /**
- * Initializes all ports and RX/TX queues.
+ * Looks up a burst of keys in a flow table and refreshes the last seen timestamp of every hit.
  * 
- * @param promisc If 1, promisc mode is turned on for all ports/devices.
- * @param rx_queues The amount of RX queues per port (recommend setting to 1).
- * @param tx_queues The amount of TX queues per port (recommend setting to 1).
+ * @param tbl A pointer to the flow table.
+ * @param keys An array of pointers to the keys.
+ * @param nb_keys The amount of keys.
+ * @param data An array the user data pointer of each key is stored in (NULL on a miss).
+ * @param now The current TSC (e.g. rte_rdtsc() once per burst).
  * 
- * @return The DPDK Common return structure (struct dpdkc_ret).
+ * @return The amount of hits or a negative error number.
 **/
-struct dpdkc_ret dpdkc_ports_queues_init(int promisc, int rx_queues, int tx_queues)
+int dpdkc_flow_table_lookup_bulk(struct dpdkc_flow_table *tbl, const void **keys, __u32 nb_keys, void **data, __u64 now)
 {
-    // Initialize return variable (custom error).
-    struct dpdkc_ret ret = dpdkc_ret_init();
+    __s32 positions[RTE_HASH_LOOKUP_BULK_MAX];
+    __u64 *ts;
+    __u32 i, j, n;
+    int hits = 0;
 
-    RTE_ETH_FOREACH_DEV(port_id)
+    // The hash library limits each bulk lookup to RTE_HASH_LOOKUP_BULK_MAX keys.
+    for (i = 0; i < nb_keys; i += n)
     {
-        // Initialize queue/port conifgs and device info.
-        int i;
-        
-        struct rte_eth_conf local_port_conf = port_conf;
-        struct rte_eth_dev_info dev_info;
+        n = RTE_MIN(nb_keys - i, (__u32)RTE_HASH_LOOKUP_BULK_MAX);
 
-        // Skip any ports not available.
-        if (!dpdkc_port_enabled())
+        if (rte_hash_lookup_bulk(tbl->hash, &keys[i], n, positions) < 0)
         {
-            fprintf(stdout, "Skipping port #%u initialize due to it being disabled.\n", port_id);
-            
-            continue;
+            return dpdkc_set_err(-EINVAL, "Flow table bulk lookup failed.");
         }
 
-        // Increment the ports available count.
-        nb_ports_available++;
-
-        // Initialize the port itself.
-        fprintf(stdout, "Initializing port #%u...\n", port_id);
-        fflush(stdout);
-
-        // Attempt to receive device information for this specific port and check.
-        if ((ret.err_num = rte_eth_dev_info_get(port_id, &dev_info)) != 0)
+        for (j = 0; j < n; j++)
         {
-            ret.port_id = port_id;
-            ret.gen_msg = "Failed to retrieve device info.";
-
-            return ret;
-        }
+            // Keys still being initialized by dpdkc_flow_table_add() count as misses.
+            if (positions[j] < 0 || __atomic_load_n(&(ts = dpdkc_flow_table_entry(tbl, positions[j]))[1], __ATOMIC_ACQUIRE) != FLOW_ENTRY_READY)
+            {
+                data[i + j] = NULL;
 
-        // Check for TX mbuf fast free support on this specific device.
-        if (dev_info.tx_offload_capa & RTE_ETH_TX_OFFLOAD_MBUF_FAST_FREE)
-        {
-            local_port_conf.txmode.offloads |= RTE_ETH_TX_OFFLOAD_MBUF_FAST_FREE;
-        }
+                continue;
+            }
 
-        // Configure the queues for this port.
-        if ((ret.err_num = rte_eth_dev_configure(port_id, rx_queues, tx_queues, &local_port_conf)) < 0)
-        {
-            ret.port_id = port_id;
-            ret.gen_msg = "Failed to configure ethernet device with RX and TX queues.";
+            // Avoid dirtying the cache line more than once per burst.
+            if (*ts != now)
+            {
+                __atomic_store_n(ts, now, __ATOMIC_RELAXED);
+            }
 
-            return ret;
+            data[i + j] = ts + 2;
+            hits++;
         }
+    }
 
-        // Retrieve MAC address of device and store in array.
-        if ((ret.err_num = rte_eth_macaddr_get(port_id, &ports[port_id].mac)) < 0)
-        {
-            ret.port_id = port_id;
-            ret.gen_msg = "Failed to retrieve MAC address on port.";
-
-            return ret;
-        }
+    return hits;
+}
 
-        // Initialize the RX queues.
-        fflush(stdout);
+/**
+ * Adds a key to a flow table (or refreshes it if it already exists).
+ * 
+ * @param tbl A pointer to the flow table.
+ * @param key A pointer to the key.
+ * @param now The current TSC.
+ * @param is_new If not NULL, set to 1 if the key was added (its data is zeroed) or 0 if it already existed. When l-cores add the same key at once, only one of them sees 1.
+ * 
+ * @return A pointer to the entry's user data or NULL if the table is full (rte_errno is set).
+**/
+void *dpdkc_flow_table_add(struct dpdkc_flow_table *tbl, const void *key, __u64 now, int *is_new)
+{
+    __s32 pos;
+    __u64 *ts;
+    __u64 state;
+    int added = 0;
 
-        for (i = 0; i < rx_queues; i++)
+    for (;;)
+    {
+        // Returns the existing position if another l-core added the key first.
+        if ((pos = rte_hash_add_key(tbl->hash, key)) < 0)
         {
-            // Initialize RX config and set values from port configuration.
-            struct rte_eth_rxconf rxq_conf;
-
-            rxq_conf = dev_info.default_rxconf;
-            rxq_conf.offloads = local_port_conf.rxmode.offloads;
-
-            // Setup the RX queue and check.
-            if ((ret.err_num = rte_eth_rx_queue_setup(port_id, i, nb_rxd, rte_eth_dev_socket_id(port_id), &rxq_conf, pcktmbuf_pool)) < 0)
-            {
-                ret.port_id = port_id;
-                ret.rx_id = i;
-                ret.gen_msg = "Failed to setup RX queue.";
-
-                return ret;
-            }
-        }
+            dpdkc_set_err(pos, "Flow table is full.");
 
-        // If we have more than one RX queue, set the port config (RX).
-        if (rx_queues > 0)
-        {
-            ports[port_id].rx = 1;
+            return NULL;
         }
 
-        // Initialize the TX queues.
-        fflush(stdout);
+        ts = dpdkc_flow_table_entry(tbl, pos);
 
-        for (i = 0; i < tx_queues; i++)
+        // Wait for the l-core that owns a new key to finish initializing it.
+        while ((state = __atomic_load_n(&ts[1], __ATOMIC_ACQUIRE)) == FLOW_ENTRY_INIT)
         {
-            // Initialize TX config and sset values from port configuration.
-            struct rte_eth_txconf txq_conf;
-
-            txq_conf = dev_info.default_txconf;
-            txq_conf.offloads = local_port_conf.txmode.offloads;
-
-            // Setup the TX queue and check.
-            if ((ret.err_num = rte_eth_tx_queue_setup(port_id, i, nb_txd, rte_eth_dev_socket_id(port_id), &txq_conf)) < 0)
-            {
-                ret.port_id = port_id;
-                ret.tx_id = i;
-                ret.gen_msg = "Failed to setup TX queue.";
-
-                return ret;
-            }
+            rte_pause();
         }
 
-        // If we have more than one TX queue, set the port config TX.
-        if (tx_queues > 0)
+        if (state == FLOW_ENTRY_READY)
         {
-            ports[port_id].tx = 1;
-
-            ports[port_id].tx_buffer = rte_zmalloc_socket("tx_buffer", RTE_ETH_TX_BUFFER_SIZE(packet_burst_size), 0, rte_eth_dev_socket_id(port_id));
-
-            // Check if the TX buffer allocation was successful.
-            if (ports[port_id].tx_buffer  == NULL)
-            {
-                ret.err_num = -1;
-                ret.port_id = port_id;
-                ret.gen_msg = "Failed to allocate TX buffer.";
-
-                return ret;
-            }
-
-            // Initialize the buffer itself within TX and check its result.
-            rte_eth_tx_buffer_init(ports[port_id].tx_buffer , packet_burst_size);
+            break;
         }
 
-        // We'll want to disable PType parsing.
-        if ((ret.err_num = rte_eth_dev_set_ptypes(port_id, RTE_PTYPE_UNKNOWN, NULL, 0)) < 0)
+        // Only one l-core may claim a free position.
+        if (!__atomic_compare_exchange_n(&ts[1], &state, FLOW_ENTRY_INIT, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
         {
-            ret.port_id = port_id;
-            ret.gen_msg = "Failed to disable PType parsing for performance.";
-
-            return ret;
+            continue;
         }
 
-        // Start the device itself.
-        if ((ret.err_num = rte_eth_dev_start(port_id)) < 0)
+        // The key may have been deleted (releasing the position) before we claimed it.
+        if (rte_hash_lookup(tbl->hash, key) != pos)
         {
-            ret.port_id = port_id;
-            ret.gen_msg = "Failed to start device.";
+            state = FLOW_ENTRY_INIT;
+            __atomic_compare_exchange_n(&ts[1], &state, FLOW_ENTRY_FREE, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
 
-            return ret;
+            continue;
         }
 
-        // Check for promiscuous mode.
-        if (promisc)
-        {
-            // If we aren't able to enable promiscuous mode, error out.
-            if ((ret.err_num = rte_eth_promiscuous_enable(port_id)) < 0)
-            {
-                ret.port_id = port_id;
-                ret.gen_msg = "Failed to enable promiscuous mode on port.";
+        // A reused position may still hold the data of an aged out flow.
+        memset(ts + 2, 0, tbl->entry_size - 2 * sizeof(*ts));
 
-                return ret;
-            }
-        }
+        __atomic_store_n(ts, now, __ATOMIC_RELAXED);
 
-        // Set verbose message.
-        fprintf(stdout, "Port #%d setup successfully with %d RX queues and %d TX queues. MAC Address => " RTE_ETHER_ADDR_PRT_FMT ".\n", port_id, rx_queues, tx_queues, RTE_ETHER_ADDR_BYTES(&ports[port_id].mac));
-    }
+        // Publish the entry unless it was deleted in the meantime (the delete already released it).
+        state = FLOW_ENTRY_INIT;
+        __atomic_compare_exchange_n(&ts[1], &state, FLOW_ENTRY_READY, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
 
-    // We're done!
-    return ret;
-}
+        added = 1;
 
-/**
- * Check if the number of available ports is above one.
- * 
- * @return The DPDK Common return structure (struct dpdkc_ret). The amount of available ports is returned in ret->data.
-**/
-struct dpdkc_ret dpdkc_ports_available()
-{
-    // Create DPDK Common's return structure.
-    struct dpdkc_ret ret = dpdkc_ret_init();
+        break;
+    }
 
-    // Check for error.
-    ret.err_num = !(nb_ports_available > 0);
+    __atomic_store_n(ts, now, __ATOMIC_RELAXED);
 
-    if (ret.err_num != 0)
+    if (is_new != NULL)
     {
-        ret.gen_msg = "Number of available ports is 0. Make sure port mask is set correctly.";
+        *is_new = added;
     }
 
-    ret.data = nb_ports_available;
-
-    return ret;
+    return ts + 2;
 }
 
 /**
- * Retrieves the amount of l-cores that are enabled and stores it in nb_lcores variable.
+ * Deletes a key from a flow table.
  * 
- * @return The DPDK Common return structure (struct dpdkc_ret). The amount of available ports is returned in ret->data.
+ * @param tbl A pointer to the flow table.
+ * @param key A pointer to the key.
+ * 
+ * @return 0 on success or a negative error number (-ENOENT if the key doesn't exist).
 **/
-struct dpdkc_ret dpdkc_get_available_lcore_count()
+int dpdkc_flow_table_del(struct dpdkc_flow_table *tbl, const void *key)
 {
-    // Create DPDK Common's return structure.
-    struct dpdkc_ret ret = dpdkc_ret_init();
-
-    // Loop through each l-core.
-    RTE_LCORE_FOREACH(lcore_id)
-    {
-        // Check if it is enabled.
-        if (rte_lcore_is_enabled(lcore_id) == 0)
-        {
-            continue;
-        }
-
-        nb_lcores++;
-    }
+    __s32 pos = rte_hash_del_key(tbl->hash, key);
 
-    // Check for none available l-cores.
-    ret.err_num = !(nb_lcores > 0);
-
-    if (ret.err_num != 0)
+    if (pos < 0)
     {
-        ret.gen_msg = "Number of enabled l-cores is 0.";
+        return dpdkc_set_err(pos, "Key isn't in flow table.");
     }
 
-    // Return number of l-cores in ret.data, but nb_lcores is also global.
-    ret.data = nb_lcores;
+    // Release ownership so whoever reuses the position initializes it.
+    __atomic_store_n(&dpdkc_flow_table_entry(tbl, pos)[1], FLOW_ENTRY_FREE, __ATOMIC_RELEASE);
 
-    return ret;
+    return 0;
 }
 
 /**
- * Launches the DPDK application and waits for all l-cores to exit.
+ * Scans a bounded amount of flow table positions from where the last call stopped and evicts entries that haven't been seen within the timeout.
+ * NOTE - Only one l-core may age a table at a time.
  * 
- * @param f A pointer to the function to launch on all l-cores when ran.
+ * @param tbl A pointer to the flow table.
+ * @param now The current TSC.
+ * @param max_scan The max amount of positions to scan.
+ * @param max_evict The max amount of entries to evict.
  * 
- * @return Void
+ * @return The amount of entries evicted.
 **/
-void dpdkc_launch_and_run(void *f)
+unsigned int dpdkc_flow_table_age(struct dpdkc_flow_table *tbl, __u64 now, unsigned int max_scan, unsigned int max_evict)
 {
-    // Launch the application on each l-core.
-    rte_eal_mp_remote_launch((int (*)(void *))f, NULL, CALL_MAIN);
+    unsigned int scanned;
+    unsigned int evicted = 0;
+    __s32 pos;
+    __u64 *ts;
+    void *key;
 
-    RTE_LCORE_FOREACH_WORKER(lcore_id)
+    for (scanned = 0; scanned < max_scan && evicted < max_evict; scanned++)
     {
-        if (rte_eal_wait_lcore(lcore_id) < 0)
+        // Wrap around once we reach the end of the table.
+        if (tbl->age_pos >= tbl->nb_positions)
         {
-            break;
+            tbl->age_pos = 0;
         }
-    }
-}
 
-/**
- * Stops and removes all running ports.
- * 
- * @return The DPDK Common return structure (struct dpdkc_ret).
-**/
-struct dpdkc_ret dpdkc_port_stop_and_remove()
-{
-    // Create DPDK Common's return structure.
-    struct dpdkc_ret ret = dpdkc_ret_init();
+        pos = tbl->age_pos++;
 
-    RTE_ETH_FOREACH_DEV(port_id)
-    {
-        // Skip disabled ports.
-        if (!dpdkc_port_enabled())
+        // Skip empty positions.
+        if (rte_hash_get_key_with_position(tbl->hash, pos, &key) != 0)
         {
             continue;
         }
 
-        fprintf(stdout, "Closing port #%u.\n", port_id);
+        ts = dpdkc_flow_table_entry(tbl, pos);
 
-        // Stop the port and check.
-        if ((ret.err_num = rte_eth_dev_stop(port_id)) != 0)
+        // Skip entries still being initialized and entries seen within the timeout. Signed, since other l-cores may have refreshed an entry after now was sampled.
+        if (__atomic_load_n(&ts[1], __ATOMIC_ACQUIRE) != FLOW_ENTRY_READY || (__s64)(now - __atomic_load_n(ts, __ATOMIC_RELAXED)) < (__s64)tbl->timeout_tsc)
         {
-            return ret;
+            continue;
         }
 
-        // Finally, close the port.
-        rte_eth_dev_close(port_id);
+        if (rte_hash_del_key(tbl->hash, key) >= 0)
+        {
+            __atomic_store_n(&ts[1], FLOW_ENTRY_FREE, __ATOMIC_RELEASE);
+
+            evicted++;
+        }
     }
 
-    return ret;
+    tbl->nb_evicted += evicted;
+
+    return evicted;
 }
 
 /**
- * Cleans up the DPDK application's EAL.
+ * Registers an l-core that accesses a flow table so deleted keys aren't freed while it may still hold them.
+ * NOTE - The l-core must then call dpdkc_flow_table_quiescent() regularly or deleted keys are never freed.
  * 
- * @return The DPDK Common return structure (struct dpdkc_ret).
+ * @param tbl A pointer to the flow table.
+ * @param lcore The l-core ID.
+ * 
+ * @return 0 on success or a negative error number.
 **/
-struct dpdkc_ret dpdkc_eal_cleanup()
+int dpdkc_flow_table_register(struct dpdkc_flow_table *tbl, unsigned int lcore)
 {
-    struct dpdkc_ret ret = dpdkc_ret_init();
+    if (rte_rcu_qsbr_thread_register(tbl->qsbr, lcore) != 0)
+    {
+        return dpdkc_set_err(-EINVAL, "Failed to register l-core with flow table.");
+    }
 
-    ret.err_num = rte_eal_cleanup();
+    rte_rcu_qsbr_thread_online(tbl->qsbr, lcore);
 
-    return ret;
+    return 0;
 }
 
 /**
- * Checks error from dpdkc_ret structure and prints error along with exits if found.
+ * Unregisters an l-core that no longer accesses a flow table (e.g. before it stops polling).
+ * 
+ * @param tbl A pointer to the flow table.
+ * @param lcore The l-core ID.
  * 
  * @return Void
 **/
-void dpdkc_check_ret(struct dpdkc_ret *ret)
+void dpdkc_flow_table_unregister(struct dpdkc_flow_table *tbl, unsigned int lcore)
 {
-    if (ret->err_num != 0)
-    {
-        char msg[256];
-        snprintf(msg, sizeof(msg) - 1, "%s Port ID => %d. RX queue ID => %d. TX queue ID => %d. Error => %s (%d).\n", (ret->gen_msg != NULL) ? ret->gen_msg : "N/A", ret->port_id, ret->rx_id, ret->tx_id, strerror(-ret->err_num), ret->err_num);
-
-        rte_exit(EXIT_FAILURE, "%s", msg);
-    }
+    rte_rcu_qsbr_thread_offline(tbl->qsbr, lcore);
+    rte_rcu_qsbr_thread_unregister(tbl->qsbr, lcore);
 }
 
 /**
- * Removes the least recently used item from a regular hash table if the table exceeds max entries.
+ * Reports a quiescent state for an l-core so keys deleted from a flow table can be freed. Every registered l-core must call this regularly (e.g. once per poll loop) outside of any table access.
  * 
- * @param tbl A pointer to the hash table.
- * @param max_entries The max entries in the table.
+ * @param tbl A pointer to the flow table.
+ * @param lcore The l-core ID.
  * 
- * @return 0 on success or -1 on error (failed to delete key from table).
+ * @return Void
 **/
-int check_and_del_lru_from_hash_table(void *tbl, __u32 max_entries)
+void dpdkc_flow_table_quiescent(struct dpdkc_flow_table *tbl, unsigned int lcore)
 {
-    static __u32 cnt = 0;
-    static __s32 pos = 0;
-
-    // Check if the entry count exceeds max entries.
-    if (cnt > max_entries)
-    {
-        // Check if the position needs to be reset.
-        if (pos >= (max_entries - 1))
-        {
-            pos = 0;
-        }
-
-        void *key;
-
-        if (rte_hash_get_key_with_position(tbl, pos, (void **)&key))
-        {
-#ifdef DEBUG
-            printf("Failed to get key %u.\n", pos);
-#endif
-        }
-
-        // Try deleting it.
-        if (rte_hash_del_key(tbl, key) < 0)
-        {
-#ifdef DEBUG
-            printf("Failed at %u.\n", pos);
-#endif
-
-            return -1;
-        }
-
-#ifdef DEBUG
-        printf("Removed at position at %u.\n", pos);
-#endif
-
-        pos++;
-    }
-
-    if (cnt <= max_entries)
-    {
-        cnt++;
-    }
-
-    return 0;
-}
\ No newline at end of file
+    rte_rcu_qsbr_quiescent(tbl->qsbr, lcore);
+}
@@ -17,11 +17,21 @@
 #include <rte_interrupts.h>
 #include <rte_random.h>
 #include <rte_debug.h>
+#include <rte_errno.h>
 #include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_flow.h>
 #include <rte_ethdev.h>
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
+#include <rte_ring.h>
 #include <rte_string_fns.h>
+#include <rte_power_intrinsics.h>
+#include <rte_cpuflags.h>
+#include <rte_alarm.h>
+#include <rte_rcu_qsbr.h>
 #ifdef USE_HASH_TABLES
 #include <rte_hash.h>
 #include <rte_jhash.h>
@@ -31,18 +41,46 @@
 
 /* Common defines */
 #define MAX_PCKT_BURST_DEFAULT 32
+#define MAX_PCKT_BURST 512
+#define ADAPTIVE_BURST_MIN 4
+#define ADAPTIVE_BURST_WINDOW 64
+#define IDLE_SLEEP_US_DEFAULT 10
+#define CLASSIFY_PREFETCH_OFFSET 4
+#define CLASSIFY_MAX_VLANS 2
 #define BURST_TX_DRAIN_US 100
 #define MEMPOOL_CACHE_SIZE 256
 #define RTE_RX_DESC_DEFAULT 1024
 #define RTE_TX_DESC_DEFAULT 1024
-#define MAX_RX_PORTS_PER_LCORE 16
-#define MAX_TX_PORTS_PER_LCORE 16
+#define PORT_MASK_WORDS ((RTE_MAX_ETHPORTS + 63) / 64)
+#define LCORE_LIST_INIT_SIZE 16
 #define MAX_RX_QUEUES_PER_PORT 16
 #define MAX_TX_QUEUES_PER_PORT 16
+#define RSS_KEY_MAX_LEN 52
+#define RSS_HF_DEFAULT (RTE_ETH_RSS_IP | RTE_ETH_RSS_TCP | RTE_ETH_RSS_UDP)
+#define TX_OFFLOADS_DESIRED_DEFAULT RTE_ETH_TX_OFFLOAD_MBUF_FAST_FREE
+#define MAX_FLOW_RULES 256
+#define FLOW_RSS_MAX_QUEUES 128
+#define FLOW_ENTRY_FREE 0
+#define FLOW_ENTRY_INIT 1
+#define FLOW_ENTRY_READY 2
+#define PIPELINE_RING_SIZE_DEFAULT 4096
+#define GEN_RAND_SRC_IP (1 << 0)
+#define GEN_RAND_DST_IP (1 << 1)
+#define GEN_RAND_SRC_PORT (1 << 2)
+#define GEN_RAND_DST_PORT (1 << 3)
+#define GEN_INC_SEQ (1 << 4)
+#define CAPTURE_RX (1 << 0)
+#define CAPTURE_TX (1 << 1)
+#define CAPTURE_RING_SIZE 4096
+#define CAPTURE_WRITE_BUF_SIZE (1 << 20)
+#define ARENA_SIZE_DEFAULT (4 << 20)
+#define ARENA_MAX_POOLS 8
+#define ERR_DETAIL_MAX 256
 #define NUM_PORTS 2
 #define MAX_TIMER_PERIOD 86400
 #define CHECK_INTERVAL 100
 #define MAX_CHECK_TIME 90
+#define LINK_POLL_MS 10
 
 /* Structures */
 struct port_pair_params
@@ -50,12 +88,61 @@ struct port_pair_params
     __u16 port[NUM_PORTS];
 } __rte_cache_aligned;
 
+struct lcore_rx_queue
+{
+    __u16 port_id;
+    __u16 queue_id;
+};
+
+enum dpdkc_lcore_role
+{
+    LCORE_ROLE_NONE,
+    LCORE_ROLE_RX,
+    LCORE_ROLE_WORKER,
+    LCORE_ROLE_TX
+};
+
+enum dpdkc_pipeline_dist
+{
+    PIPELINE_DIST_BURST,
+    PIPELINE_DIST_FLOW
+};
+
+enum dpdkc_tx_drain
+{
+    TX_DRAIN_DEFAULT = 0,
+    TX_DRAIN_FULL = 1 << 0,
+    TX_DRAIN_IDLE = 1 << 1,
+    TX_DRAIN_DEADLINE = 1 << 2
+};
+
+enum dpdkc_port_state
+{
+    PORT_STATE_DOWN,
+    PORT_STATE_UP,
+    PORT_STATE_REMOVED
+};
+
 struct lcore_port_conf
 {
+    // Dynamically sized lists (grown from LCORE_LIST_INIT_SIZE entries as ports and queues are mapped).
     unsigned num_rx_ports;
-    unsigned rx_port_list[MAX_RX_PORTS_PER_LCORE];
+    unsigned max_rx_ports;
+    unsigned *rx_port_list;
     unsigned num_tx_ports;
-    unsigned tx_port_list[MAX_TX_PORTS_PER_LCORE];
+    unsigned max_tx_ports;
+    unsigned *tx_port_list;
+    unsigned num_rx_queues;
+    unsigned max_rx_queues;
+    struct lcore_rx_queue *rx_queue_list;
+    __u16 tx_queue_id;
+    struct rte_eth_dev_tx_buffer *tx_buffer[RTE_MAX_ETHPORTS];
+    struct rte_mempool *pool;
+    unsigned int role;
+    struct rte_ring *in_ring;
+    struct rte_ring *out_ring;
+    unsigned int tx_drain_policy;
+    __u64 tx_drain_tsc;
 } __rte_cache_aligned;
 
 struct port_conf
@@ -65,8 +152,219 @@ struct port_conf
     struct rte_ether_addr mac;
     struct rte_eth_dev_tx_buffer *tx_buffer;
     unsigned int tx_port;
+    unsigned int offloads_set : 1;
+    __u64 rx_offloads_desired;
+    __u64 rx_offloads_required;
+    __u64 tx_offloads_desired;
+    __u64 tx_offloads_required;
+    __u64 rx_offloads;
+    __u64 tx_offloads;
+    unsigned int nb_hw_flow_rules;
+    unsigned int hw_flow_rule_limit;
+    unsigned int nb_sw_flow_rules;
+    unsigned int lsc_intr : 1;
+    __u8 state;
+};
+
+enum dpdkc_flow_action
+{
+    FLOW_ACTION_DROP,
+    FLOW_ACTION_QUEUE,
+    FLOW_ACTION_MARK,
+    FLOW_ACTION_RSS
+};
+
+struct dpdkc_flow_rule
+{
+    __u16 port_id;
+    __u32 priority;
+
+    // Match (zero fields are wildcards). IP addresses/masks and ports are in network byte order.
+    __u16 ether_type;
+    __u32 src_ip;
+    __u32 src_mask;
+    __u32 dst_ip;
+    __u32 dst_mask;
+    __u8 l4_proto;
+    __u16 src_port;
+    __u16 dst_port;
+
+    // Action.
+    enum dpdkc_flow_action action;
+    __u16 queue;
+    __u32 mark;
+    __u16 rss_queue_start;
+    __u16 rss_nb_queues;
+};
+
+struct dpdkc_flow_handle
+{
+    unsigned int used : 1;
+    unsigned int in_hw : 1;
+    struct dpdkc_flow_rule rule;
+    struct rte_flow *flow;
+};
+
+struct dpdkc_lcore_map
+{
+    unsigned int num_rx_queues;
+    unsigned int max_rx_queues;
+    struct lcore_rx_queue *rx_queue_list;
+};
+
+struct dpdkc_fwd_conf
+{
+    // The RX queues each l-core polls (the lists are owned by the config).
+    struct dpdkc_lcore_map lcores[RTE_MAX_LCORE];
+
+    // The port packets received on each port are sent to.
+    __u16 tx_port[RTE_MAX_ETHPORTS];
+
+    // Software flow rules sorted by port and priority (rebuilt from the installed rules on every commit).
+    __u16 sw_rule_start[RTE_MAX_ETHPORTS];
+    __u16 nb_sw_rules[RTE_MAX_ETHPORTS];
+    struct dpdkc_flow_rule sw_rules[MAX_FLOW_RULES];
+} __rte_cache_aligned;
+
+/* Batch callback used by the built-in forwarder (see dpdkc_run_forwarder()) */
+typedef __u16 (*dpdkc_batch_cb)(__u16 rx_port, struct rte_mbuf **pkts, __u16 nb_pkts);
+
+/* Capture filter (see dpdkc_capture_start()). Returns 1 to capture the packet */
+typedef int (*dpdkc_capture_filter)(const struct rte_mbuf *m);
+
+#ifdef USE_LATENCY_HIST
+#define LATENCY_HIST_SUB_BITS 2
+#define LATENCY_HIST_BUCKETS (64 << LATENCY_HIST_SUB_BITS)
+
+enum dpdkc_hist_type
+{
+    HIST_RX_BURST = 0,
+    HIST_CALLBACK,
+    HIST_TX_FLUSH,
+    HIST_MAX
+};
+
+struct dpdkc_latency_hist
+{
+    __u64 buckets[HIST_MAX][LATENCY_HIST_BUCKETS];
+    __u64 count[HIST_MAX];
+    __u64 max[HIST_MAX];
+} __rte_cache_aligned;
+#endif
+
+struct dpdkc_pkt_meta
+{
+    __u16 nb_pkts;
+    __u16 ether_type[MAX_PCKT_BURST];
+    __u16 l3_off[MAX_PCKT_BURST];
+    __u16 l4_off[MAX_PCKT_BURST];
+    __u8 l4_proto[MAX_PCKT_BURST];
+    __u32 src_ip[MAX_PCKT_BURST];
+    __u32 dst_ip[MAX_PCKT_BURST];
+    __u16 src_port[MAX_PCKT_BURST];
+    __u16 dst_port[MAX_PCKT_BURST];
+    __u32 rss[MAX_PCKT_BURST];
+} __rte_cache_aligned;
+
+struct dpdkc_gen_conf
+{
+    // The template packet (Ethernet frame). Field randomization requires IPv4 (and TCP/UDP for ports and sequence numbers).
+    const __u8 *pkt;
+    __u16 pkt_len;
+    __u16 tx_port;
+
+    // The rate per l-core in packets per second (0 sends as fast as possible).
+    __u64 pps;
+
+    // Fields rewritten in each packet (GEN_RAND_* and GEN_INC_SEQ).
+    __u32 rand_fields;
+
+    // The amount of values randomized from the template's value upwards (host byte order, 0 means any value).
+    __u32 src_ip_range;
+    __u32 dst_ip_range;
+    __u16 src_port_range;
+    __u16 dst_port_range;
+
+    // If 1, send reference counted clones of one pre-built mbuf per l-core (no per-packet writes or randomization).
+    unsigned int clone;
+};
+
+struct dpdkc_lcore_stats
+{
+    __u64 rx_pkts;
+    __u64 rx_bytes;
+    __u64 tx_pkts;
+    __u64 tx_bytes;
+    __u64 dropped;
+    __u64 tx_dropped;
+    __u64 empty_polls;
+    __u64 tx_flushes;
+    __u64 idle_sleeps;
+    __u64 cap_seen;
+    __u64 cap_pkts;
+    __u64 cap_dropped;
+} __rte_cache_aligned;
+
+struct dpdkc_objpool
+{
+    void *free_list;
+    __u32 obj_size;
+    __u32 nb_objs;
+    __u32 nb_free;
+    __u32 min_free;
+    __u64 failed;
 };
 
+struct dpdkc_arena
+{
+    __u8 *base;
+    size_t size;
+    size_t off;
+
+    // Object pools are carved below the floor, which resets don't go past.
+    size_t floor;
+    size_t high_water;
+    __u64 allocs;
+    __u64 failed;
+    __u64 resets;
+    unsigned int nb_pools;
+    struct dpdkc_objpool pools[ARENA_MAX_POOLS];
+} __rte_cache_aligned;
+
+struct dpdkc_lcore_ctx
+{
+    unsigned int lcore_id;
+    unsigned int socket_id;
+    unsigned int is_main;
+    __u16 tx_queue_id;
+
+    // The l-core's config (TX buffers and mempool, see dpdkc_fwd_conf_get() for its RX queues), statistics and arena (scratch memory).
+    struct lcore_port_conf *conf;
+    struct dpdkc_lcore_stats *stats;
+    struct dpdkc_arena *arena;
+    struct rte_mempool *pool;
+#ifdef USE_LATENCY_HIST
+    struct dpdkc_latency_hist *hist;
+#endif
+
+    // Application data (set before launching, kept across launches).
+    void *data;
+} __rte_cache_aligned;
+
+#ifdef USE_HASH_TABLES
+struct dpdkc_flow_table
+{
+    struct rte_hash *hash;
+    struct rte_rcu_qsbr *qsbr;
+    __u8 *entries;
+    __u32 entry_size;
+    __u32 nb_positions;
+    __u64 timeout_tsc;
+    __u32 age_pos;
+    __u64 nb_evicted;
+} __rte_cache_aligned;
+#endif
+
 struct dpdkc_ret
 {
     char *gen_msg;
@@ -83,7 +381,7 @@ struct dpdkc_ret
 extern volatile __u8 quit;
 extern __u16 nb_rxd;
 extern __u16 nb_txd;
-extern __u32 enabled_port_mask;
+extern __u64 enabled_port_mask[PORT_MASK_WORDS];
 extern struct port_pair_params port_pair_params_array[RTE_MAX_ETHPORTS / 2];
 extern struct port_pair_params *port_pair_params;
 extern __u16 nb_port_pair_params;
@@ -95,21 +393,53 @@ extern unsigned int tx_queue_pp;
 extern struct lcore_port_conf lcore_port_conf[RTE_MAX_LCORE];
 extern unsigned int packet_burst_size;
 extern struct rte_eth_conf port_conf;
+extern __u64 rss_hf;
+extern __u8 rss_key[RSS_KEY_MAX_LEN];
+extern __u8 rss_key_len;
 extern struct rte_mempool *pcktmbuf_pool;
+extern struct rte_mempool *pcktmbuf_pools[RTE_MAX_NUMA_NODES];
+extern __u16 mbuf_data_room;
+extern __u16 mbuf_priv_size;
+extern unsigned int mbuf_extra;
 extern __u16 port_id;
 extern __u16 nb_ports;
 extern __u16 nb_ports_available;
 extern unsigned int lcore_id;
 extern unsigned int nb_lcores;
+extern struct dpdkc_lcore_stats lcore_stats[RTE_MAX_LCORE];
+extern unsigned int stats_period;
+extern unsigned int adaptive_burst;
+extern unsigned int idle_poll_threshold;
+extern unsigned int idle_sleep_us;
+extern unsigned int idle_power_monitor;
+extern struct dpdkc_flow_handle flow_rules[MAX_FLOW_RULES];
+extern unsigned int pipeline_ring_size;
+extern unsigned int pipeline_dist_mode;
+extern unsigned int arena_size;
+extern unsigned int parallel_port_init;
+extern struct dpdkc_arena lcore_arena[RTE_MAX_LCORE];
+extern struct dpdkc_lcore_ctx lcore_ctx[RTE_MAX_LCORE];
+extern struct dpdkc_fwd_conf *fwd_conf;
+RTE_DECLARE_PER_LCORE(const char *, dpdkc_errmsg);
+#ifdef USE_LATENCY_HIST
+extern struct dpdkc_latency_hist lcore_hist[RTE_MAX_LCORE];
+#endif
 #endif
 
 /* Functions for use in other objects/executables using this header file */
 struct dpdkc_ret dpdkc_ret_init();
+int dpdkc_set_errf(int err, const char *fmt, ...) __rte_format_printf(2, 3);
+const char *dpdkc_err_detail();
 struct dpdkc_ret dpdkc_parse_arg_port_mask(const char *arg);
+struct dpdkc_ret dpdkc_parse_arg_port_list(const char *arg);
 struct dpdkc_ret dpdkc_parse_arg_port_pair_config(const char *arg);
 struct dpdkc_ret dpdkc_parse_arg_queues(const char *arg, int rx, int tx);
+struct dpdkc_ret dpdkc_parse_arg_stats_period(const char *arg);
+struct dpdkc_ret dpdkc_parse_arg_pipeline(const char *arg, int role);
 struct dpdkc_ret dpdkc_check_port_pair_config(void);
 void dpdkc_check_link_status();
+struct dpdkc_ret dpdkc_wait_link_up(unsigned int timeout_ms);
+void dpdkc_startup_timing_print();
 struct dpdkc_ret dpdkc_eal_init(int argc, char **argv);
 struct dpdkc_ret dpdkc_get_nb_ports();
 struct dpdkc_ret dpdkc_check_port_pairs();
@@ -117,15 +447,327 @@ struct dpdkc_ret dpdkc_ports_are_valid();
 void dpdkc_reset_dst_ports();
 void dpdkc_populate_dst_ports();
 struct dpdkc_ret dpdkc_ports_queues_mapping();
+struct dpdkc_ret dpdkc_ports_queues_mapping_rss();
+struct dpdkc_ret dpdkc_pipeline_mapping();
+int dpdkc_lcore_add_rx_queue(struct lcore_port_conf *qconf, __u16 pid, __u16 queue);
+int dpdkc_lcore_add_port(struct lcore_port_conf *qconf, __u16 pid, int tx);
+struct dpdkc_ret dpdkc_request_offloads(int pid, __u64 rx_desired, __u64 rx_required, __u64 tx_desired, __u64 tx_required);
+struct dpdkc_ret dpdkc_set_rss(const __u8 *key, __u8 key_len, __u64 hf);
+unsigned int dpdkc_calc_nb_mbufs(unsigned int nb_pool_ports, unsigned int nb_pool_lcores);
 struct dpdkc_ret dpdkc_create_mbuf();
+struct rte_mempool *dpdkc_get_socket_pool(int socket_id);
 struct dpdkc_ret dpdkc_ports_queues_init(int promisc, int rx_queue, int tx_queue);
+struct dpdkc_ret dpdkc_port_attach(__u16 pid);
+struct dpdkc_fwd_conf *dpdkc_reconf_begin();
+struct dpdkc_ret dpdkc_reconf_move_queue(struct dpdkc_fwd_conf *conf, __u16 pid, __u16 queue, unsigned int lcore);
+struct dpdkc_ret dpdkc_reconf_commit(struct dpdkc_fwd_conf *conf);
+void dpdkc_reconf_abort(struct dpdkc_fwd_conf *conf);
+void dpdkc_lcore_online();
+void dpdkc_lcore_offline();
+void dpdkc_lcore_quiescent();
+struct dpdkc_ret dpdkc_port_hotplug_add(const char *devargs);
 struct dpdkc_ret dpdkc_get_available_lcore_count();
 struct dpdkc_ret dpdkc_ports_available();
 void dpdkc_launch_and_run(void *f);
+struct dpdkc_ret dpdkc_set_tx_drain(int lcore, unsigned int policy, __u64 drain_us);
+void dpdkc_set_tx_err_callback(buffer_tx_error_fn cb, void *userdata);
+void dpdkc_run_forwarder(dpdkc_batch_cb cb);
+struct dpdkc_ret dpdkc_pipeline_init();
+void dpdkc_pipeline_free();
+void dpdkc_run_pipeline(dpdkc_batch_cb cb);
+struct dpdkc_ret dpdkc_gen_init(const struct dpdkc_gen_conf *conf);
+void dpdkc_gen_free();
+void dpdkc_run_generator();
+struct dpdkc_ret dpdkc_capture_start(const char *path, unsigned int dirs, unsigned int sample, __u32 snaplen, dpdkc_capture_filter filter);
+void dpdkc_capture_burst(struct rte_mbuf **pkts, __u16 nb_pkts, unsigned int dir);
+struct dpdkc_ret dpdkc_capture_stop();
+struct dpdkc_ret dpdkc_replay_load(const char *path);
+struct dpdkc_ret dpdkc_run_replay(dpdkc_batch_cb cb, __u16 rx_port, __u64 pps, unsigned int loops);
+void dpdkc_replay_free();
+struct dpdkc_ret dpdkc_arenas_init();
+struct dpdkc_ret dpdkc_objpool_create(int lcore, __u32 obj_size, __u32 nb_objs);
+void dpdkc_arenas_free();
+void dpdkc_arena_stats_print();
 struct dpdkc_ret dpdkc_port_stop_and_remove();
 struct dpdkc_ret dpdkc_eal_cleanup();
 void dpdkc_check_ret(struct dpdkc_ret *ret);
+void dpdkc_stats_print();
+void dpdkc_classify_burst(struct rte_mbuf **pkts, __u16 nb_pkts, struct dpdkc_pkt_meta *meta);
+struct dpdkc_ret dpdkc_flow_rule_validate(const struct dpdkc_flow_rule *rule);
+struct dpdkc_ret dpdkc_flow_rule_install(const struct dpdkc_flow_rule *rule, int sw_fallback);
+struct dpdkc_ret dpdkc_flow_rule_remove(__u32 id);
+void dpdkc_flow_rules_flush(__u16 pid);
+__u16 dpdkc_flow_sw_filter(__u16 pid, struct rte_mbuf **pkts, __u16 nb_pkts);
+void dpdkc_stats_print_xstats(__u16 pid);
+
+#ifndef DPDK_COMMON_IGNORE_GLOBAL_VARS
+/**
+ * Records the error of a datapath function in the calling thread (rte_errno and the detail returned by dpdkc_err_detail()) without allocating.
+ * NOTE - Datapath functions return 0 (or a count) on success and a negative error number on failure instead of struct dpdkc_ret. Functions returning pointers return NULL and set rte_errno.
+ * 
+ * @param err The negative error number.
+ * @param detail A constant string describing the error (stored by pointer, not copied).
+ * 
+ * @return The error number passed.
+**/
+static inline int dpdkc_set_err(int err, const char *detail)
+{
+    rte_errno = -err;
+    RTE_PER_LCORE(dpdkc_errmsg) = detail;
+
+    return err;
+}
+
+/**
+ * Checks whether a port's bit is set in a port mask (e.g. enabled_port_mask).
+ * 
+ * @param mask A pointer to the port mask (PORT_MASK_WORDS words).
+ * @param pid The port ID.
+ * 
+ * @return 1 if set or 0 otherwise (including port IDs at or above RTE_MAX_ETHPORTS).
+**/
+static inline int dpdkc_port_mask_test(const __u64 *mask, unsigned int pid)
+{
+    return pid < RTE_MAX_ETHPORTS && ((mask[pid / 64] >> (pid % 64)) & 1);
+}
+
+/**
+ * Sets a port's bit in a port mask.
+ * 
+ * @param mask A pointer to the port mask (PORT_MASK_WORDS words).
+ * @param pid The port ID (must be below RTE_MAX_ETHPORTS).
+ * 
+ * @return Void
+**/
+static inline void dpdkc_port_mask_set(__u64 *mask, unsigned int pid)
+{
+    mask[pid / 64] |= 1ULL << (pid % 64);
+}
+
+/**
+ * Clears a port's bit in a port mask.
+ * 
+ * @param mask A pointer to the port mask (PORT_MASK_WORDS words).
+ * @param pid The port ID (must be below RTE_MAX_ETHPORTS).
+ * 
+ * @return Void
+**/
+static inline void dpdkc_port_mask_clear(__u64 *mask, unsigned int pid)
+{
+    mask[pid / 64] &= ~(1ULL << (pid % 64));
+}
+
+/**
+ * Checks whether a port is usable from the fast path. Ports are marked down by link status change events and removed by device removal events, after which the built-in loops skip them.
+ * 
+ * @param pid The port ID.
+ * 
+ * @return 1 if the port is up or 0 otherwise.
+**/
+static inline int dpdkc_port_is_up(__u16 pid)
+{
+    return __atomic_load_n(&ports[pid].state, __ATOMIC_ACQUIRE) == PORT_STATE_UP;
+}
+
+/**
+ * Checks whether RX offloads were negotiated on a port (e.g. to skip verifying checksums in software).
+ * 
+ * @param pid The port ID.
+ * @param offloads The RX offloads (RTE_ETH_RX_OFFLOAD_*).
+ * 
+ * @return 1 if all offloads are enabled on the port or 0 otherwise.
+**/
+static inline int dpdkc_port_rx_offloaded(__u16 pid, __u64 offloads)
+{
+    return (ports[pid].rx_offloads & offloads) == offloads;
+}
+
+/**
+ * Checks whether TX offloads were negotiated on a port (e.g. to leave checksums to the NIC).
+ * 
+ * @param pid The port ID.
+ * @param offloads The TX offloads (RTE_ETH_TX_OFFLOAD_*).
+ * 
+ * @return 1 if all offloads are enabled on the port or 0 otherwise.
+**/
+static inline int dpdkc_port_tx_offloaded(__u16 pid, __u64 offloads)
+{
+    return (ports[pid].tx_offloads & offloads) == offloads;
+}
+
+/**
+ * Allocates memory from the calling l-core's arena (see dpdkc_arenas_init()) by bumping its offset. The memory is valid until the next dpdkc_arena_reset() and is never freed individually.
+ * NOTE - Only call from the l-core owning the arena (EAL threads).
+ * 
+ * @param size The amount of bytes to allocate.
+ * @param align The alignment (a power of 2 up to RTE_CACHE_LINE_SIZE).
+ * 
+ * @return A pointer to the memory or NULL if the arena is full (rte_errno is set to ENOMEM).
+**/
+static inline void *dpdkc_arena_alloc(size_t size, size_t align)
+{
+    struct dpdkc_arena *arena = &lcore_arena[rte_lcore_id()];
+    size_t off = RTE_ALIGN_CEIL(arena->off, align);
+
+    if (unlikely(off + size > arena->size))
+    {
+        arena->failed++;
+
+        dpdkc_set_err(-ENOMEM, "L-core arena is full.");
+
+        return NULL;
+    }
+
+    arena->off = off + size;
+    arena->allocs++;
+
+    if (arena->off > arena->high_water)
+    {
+        arena->high_water = arena->off;
+    }
+
+    return arena->base + off;
+}
+
+/**
+ * Releases everything allocated from the calling l-core's arena with dpdkc_arena_alloc() at once (object pools are kept). The built-in loops call this before every batch callback.
+ * 
+ * @return Void
+**/
+static inline void dpdkc_arena_reset()
+{
+    struct dpdkc_arena *arena = &lcore_arena[rte_lcore_id()];
+
+    arena->off = arena->floor;
+    arena->resets++;
+}
+
+/**
+ * Takes an object from one of the calling l-core's object pools (see dpdkc_objpool_create()).
+ * 
+ * @param id The pool ID.
+ * 
+ * @return A pointer to the object or NULL if the pool is empty (rte_errno is set to ENOBUFS).
+**/
+static inline void *dpdkc_objpool_get(unsigned int id)
+{
+    struct dpdkc_objpool *pool = &lcore_arena[rte_lcore_id()].pools[id];
+    void *obj = pool->free_list;
+
+    if (unlikely(obj == NULL))
+    {
+        pool->failed++;
+
+        dpdkc_set_err(-ENOBUFS, "Object pool is empty.");
+
+        return NULL;
+    }
+
+    pool->free_list = *(void **)obj;
+    pool->nb_free--;
+
+    if (pool->nb_free < pool->min_free)
+    {
+        pool->min_free = pool->nb_free;
+    }
+
+    return obj;
+}
+
+/**
+ * Returns an object to one of the calling l-core's object pools.
+ * NOTE - The object must come from the same l-core's pool.
+ * 
+ * @param id The pool ID.
+ * @param obj A pointer to the object.
+ * 
+ * @return Void
+**/
+static inline void dpdkc_objpool_put(unsigned int id, void *obj)
+{
+    struct dpdkc_objpool *pool = &lcore_arena[rte_lcore_id()].pools[id];
+
+    *(void **)obj = pool->free_list;
+    pool->free_list = obj;
+    pool->nb_free++;
+}
+
+/**
+ * Retrieves the published forwarding config. L-core loops should read their RX queues from it (lcores[lcore_id]) rather than lcore_port_conf[], whose lists dpdkc_reconf_commit() may reallocate while l-cores run.
+ * NOTE - Only dereference between dpdkc_lcore_quiescent() calls on l-cores registered with dpdkc_lcore_online().
+ * 
+ * @return A pointer to the config or NULL if none was published yet.
+**/
+static inline const struct dpdkc_fwd_conf *dpdkc_fwd_conf_get()
+{
+    return __atomic_load_n(&fwd_conf, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Retrieves the calling l-core's context for code that isn't handed one (e.g. batch callbacks).
+ * NOTE - Filled by dpdkc_launch_and_run() (functions it launches receive the same pointer as their argument).
+ * 
+ * @return A pointer to the l-core's context.
+**/
+static inline struct dpdkc_lcore_ctx *dpdkc_lcore_ctx_get()
+{
+    return &lcore_ctx[rte_lcore_id()];
+}
+#endif
+
+#ifdef USE_LATENCY_HIST
+void dpdkc_latency_hist_dump();
+void dpdkc_latency_hist_reset();
+
+/**
+ * Records an amount of TSC cycles into a log-scale histogram bucket (power of two plus LATENCY_HIST_SUB_BITS bits of precision).
+ * 
+ * @param hist A pointer to the l-core's histograms.
+ * @param type The histogram type (enum dpdkc_hist_type).
+ * @param cycles The amount of TSC cycles.
+ * 
+ * @return Void
+**/
+static inline void dpdkc_latency_hist_record(struct dpdkc_latency_hist *hist, int type, __u64 cycles)
+{
+    unsigned int msb, idx;
+
+    if (cycles < (1 << LATENCY_HIST_SUB_BITS))
+    {
+        idx = cycles;
+    }
+    else
+    {
+        msb = 63 - __builtin_clzll(cycles);
+        idx = ((msb - LATENCY_HIST_SUB_BITS + 1) << LATENCY_HIST_SUB_BITS) | ((cycles >> (msb - LATENCY_HIST_SUB_BITS)) & ((1 << LATENCY_HIST_SUB_BITS) - 1));
+    }
+
+    hist->buckets[type][idx]++;
+    hist->count[type]++;
+
+    if (cycles > hist->max[type])
+    {
+        hist->max[type] = cycles;
+    }
+}
+
+#define DPDKC_HIST_START(var) __u64 var = rte_rdtsc()
+#define DPDKC_HIST_RECORD(hist, type, start) dpdkc_latency_hist_record(hist, type, rte_rdtsc() - (start))
+#else
+#define DPDKC_HIST_START(var)
+#define DPDKC_HIST_RECORD(hist, type, start)
+#endif
+
 #ifdef USE_HASH_TABLES
 int check_and_del_lru_from_hash_table(void *tbl, __u32 max_entries);
+struct dpdkc_ret dpdkc_flow_table_create(const char *name, __u32 max_entries, __u32 key_len, __u32 data_size, __u64 timeout_us, int socket_id);
+void dpdkc_flow_table_free(struct dpdkc_flow_table *tbl);
+int dpdkc_flow_table_lookup_bulk(struct dpdkc_flow_table *tbl, const void **keys, __u32 nb_keys, void **data, __u64 now);
+void *dpdkc_flow_table_add(struct dpdkc_flow_table *tbl, const void *key, __u64 now, int *is_new);
+int dpdkc_flow_table_del(struct dpdkc_flow_table *tbl, const void *key);
+unsigned int dpdkc_flow_table_age(struct dpdkc_flow_table *tbl, __u64 now, unsigned int max_scan, unsigned int max_evict);
+int dpdkc_flow_table_register(struct dpdkc_flow_table *tbl, unsigned int lcore);
+void dpdkc_flow_table_unregister(struct dpdkc_flow_table *tbl, unsigned int lcore);
+void dpdkc_flow_table_quiescent(struct dpdkc_flow_table *tbl, unsigned int lcore);
 #endif
 #endif
\ No newline at end of file